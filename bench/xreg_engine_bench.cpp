@@ -0,0 +1,103 @@
+// Copyright (c) 2017-2018 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// runs the same synthetic actions on the register engine and on the lua engine,
+// prints one json object per engine and action:
+//   xreg_engine_bench [tx num] [loop num]
+
+#include <cstdio>
+#include <cstdlib>
+#include "xvm/bench/xvm_bench_util.h"
+#include "xvm/xreg_engine.h"
+
+using namespace top;
+using namespace top::xvm;
+
+static const char* s_lua_code = R"(
+function bench_sum(n)
+    local sum = 0
+    while n ~= 0 do
+        sum = sum + n
+        n = n - 1
+    end
+    return tostring(sum)
+end
+
+function bench_concat(n)
+    local s = ""
+    while n ~= 0 do
+        s = s .. "ab"
+        n = n - 1
+    end
+end
+)";
+
+static const char* s_reg_code = XREG_ENGINE_HEADER R"(
+action bench_sum 1
+    arg     r0 0
+    loadi   r1 0
+    loadi   r2 1
+loop:
+    jz      r0 done
+    add     r1 r1 r0
+    sub     r0 r0 r2
+    jmp     loop
+done:
+    tostr   r3 r1
+end
+
+action bench_concat 1
+    arg     r0 0
+    loads   r1 ""
+    loads   r2 "ab"
+    loadi   r3 1
+loop:
+    jz      r0 done
+    concat  r1 r1 r2
+    sub     r0 r0 r3
+    jmp     loop
+done:
+end
+)";
+
+static void bench(xvm_bench_chain& chain, const char* engine, const std::string& address, const std::string& code, uint64_t tx_num, uint64_t loop_num) {
+    xvm_service service;
+    auto trace = chain.publish(service, address, code, 0);
+    if (trace->m_errno != enum_xvm_error_code::ok) {
+        std::printf("{\"engine\":\"%s\",\"error\":\"publish: %s\"}\n", engine, trace->m_errmsg.c_str());
+        return;
+    }
+
+    auto param = xvm_bench_chain::uint64_param({loop_num});
+    for (auto action : {"bench_sum", "bench_concat"}) {
+        uint64_t errors{0}, instructions{0};
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < tx_num; i++) {
+            trace = chain.call(service, address, action, param);
+            errors += trace->m_errno != enum_xvm_error_code::ok;
+            instructions += trace->m_instruction_usage;
+        }
+        auto elapsed_us = xvm_bench_elapsed_us(start);
+        std::printf("{\"engine\":\"%s\",\"action\":\"%s\",\"tx_num\":%llu,\"loop_num\":%llu,\"error_num\":%llu,"
+                    "\"elapsed_us\":%llu,\"tx_per_sec\":%llu,\"us_per_tx\":%llu,\"instructions_per_tx\":%llu}\n",
+                    engine, action,
+                    static_cast<unsigned long long>(tx_num),
+                    static_cast<unsigned long long>(loop_num),
+                    static_cast<unsigned long long>(errors),
+                    static_cast<unsigned long long>(elapsed_us),
+                    static_cast<unsigned long long>(elapsed_us > 0 ? tx_num * 1000000 / elapsed_us : 0),
+                    static_cast<unsigned long long>(tx_num > 0 ? elapsed_us / tx_num : 0),
+                    static_cast<unsigned long long>(tx_num > 0 ? instructions / tx_num : 0));
+    }
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t tx_num = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000;
+    uint64_t loop_num = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000;
+
+    xvm_bench_chain chain;
+    bench(chain, "lua", "T-3-xvm-bench-lua", s_lua_code, tx_num, loop_num);
+    bench(chain, "xreg", "T-3-xvm-bench-xreg", s_reg_code, tx_num, loop_num);
+    return 0;
+}
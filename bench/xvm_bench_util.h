@@ -0,0 +1,138 @@
+// Copyright (c) 2017-2018 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "xbase/xcontext.h"
+#include "xbase/xmem.h"
+#include "xdata/xtransaction.h"
+#include "xstore/xstore_face.h"
+#include "xvm/xlua_abi.h"
+#include "xvm/xvm_service.h"
+NS_BEG2(top, xvm)
+
+/**
+ * @brief an in-memory chain to deploy and call contracts on, for the benchmarks. no block is
+ *        made, the account context of a contract is kept so the calls see the earlier writes
+ *
+ */
+class xvm_bench_chain {
+public:
+    xvm_bench_chain()
+    :m_store(store::xstore_factory::create_store_with_memdb()) {
+    }
+
+    /**
+     * @brief publish the contract code to the address
+     *
+     * @param service  the vm service
+     * @param address  the contract address
+     * @param code  the contract code
+     * @param tgas_limit  the tgas limit of the contract, 0 means no limit
+     * @param abi  the abi descriptor of the contract, empty means no abi
+     * @return xtransaction_trace_ptr  the trace
+     */
+    xtransaction_trace_ptr publish(xvm_service& service, const std::string& address, const std::string& code, uint64_t tgas_limit, const std::string& abi = "") {
+        auto tx = make_object_ptr<data::xtransaction_t>();
+        data::xproperty_asset asset_out{0};
+        tx->make_tx_create_contract_account(asset_out, tgas_limit, code);
+        tx->set_same_source_target_address(address);
+        tx->set_digest();
+        auto trace = service.deal_transaction(tx, &account_context(address));
+        if (trace->m_errno != enum_xvm_error_code::ok || abi.empty()) {
+            return trace;
+        }
+        // the create transaction has no abi field, write the property the publish would write
+        // and drop the cached engine, the next call loads the contract with the abi
+        if (account_context(address).string_set(XPROPERTY_CONTRACT_ABI_KEY, abi, true)) {
+            trace->m_errno = enum_xvm_error_code::enum_vm_exception;
+            trace->m_errmsg = "set abi error";
+            return trace;
+        }
+        std::shared_ptr<xengine> engine;
+        service.m_vm_cache.take(common::xaccount_address_t{address}, engine);
+        return trace;
+    }
+
+    /**
+     * @brief call the action of the contract
+     *
+     * @param service  the vm service
+     * @param address  the contract address
+     * @param action  the action name
+     * @param param  the action param, see uint64_param
+     * @return xtransaction_trace_ptr  the trace
+     */
+    xtransaction_trace_ptr call(xvm_service& service, const std::string& address, const std::string& action, const std::string& param) {
+        auto tx = make_object_ptr<data::xtransaction_t>();
+        data::xproperty_asset asset_out{0};
+        tx->make_tx_run_contract(asset_out, action, param);
+        tx->set_same_source_target_address(address);
+        tx->set_digest();
+        return service.deal_transaction(tx, &account_context(address));
+    }
+
+    /**
+     * @brief encode uint64 action args, accepted by contracts with and without abi
+     *
+     * @param args  the args
+     * @return std::string  the action param
+     */
+    static std::string uint64_param(std::vector<uint64_t> const & args) {
+        base::xstream_t stream(base::xcontext_t::instance());
+        stream << static_cast<uint8_t>(args.size());
+        for (auto arg : args) {
+            stream << ARG_TYPE_UINT64;
+            stream << arg;
+        }
+        return std::string(reinterpret_cast<char*>(stream.data()), stream.size());
+    }
+
+    /**
+     * @brief encode arg_num action args, uint64 and string in turn, accepted by contracts
+     *        with and without abi
+     *
+     * @param n  the seed of the arg values
+     * @param arg_num  the number of args, at most MAX_ARG_NUM
+     * @return std::string  the action param
+     */
+    static std::string mixed_param(uint64_t n, uint8_t arg_num) {
+        base::xstream_t stream(base::xcontext_t::instance());
+        stream << arg_num;
+        for (uint8_t i = 0; i < arg_num; i++) {
+            if (i % 2 == 0) {
+                stream << ARG_TYPE_UINT64;
+                stream << static_cast<uint64_t>(n + i);
+            } else {
+                stream << ARG_TYPE_STRING;
+                stream << std::string("bench-arg-") + std::to_string(n + i);
+            }
+        }
+        return std::string(reinterpret_cast<char*>(stream.data()), stream.size());
+    }
+
+private:
+    xaccount_context_t& account_context(const std::string& address) {
+        auto & ac = m_account_contexts[address];
+        if (ac == nullptr) {
+            ac.reset(new xaccount_context_t(address, m_store.get()));
+        }
+        return *ac;
+    }
+
+private:
+    xobject_ptr_t<store::xstore_face_t>                                     m_store;
+    std::unordered_map<std::string, std::unique_ptr<xaccount_context_t>>    m_account_contexts;
+};
+
+inline uint64_t xvm_bench_elapsed_us(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+NS_END2
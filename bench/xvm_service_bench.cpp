@@ -0,0 +1,122 @@
+// Copyright (c) 2017-2018 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// runs a synthetic contract corpus through xvm_service::deal_transaction and prints
+// the service stats as one json object:
+//   xvm_service_bench [tx num] [contract num]
+
+#include <cstdio>
+#include <cstdlib>
+#include "xvm/bench/xvm_bench_util.h"
+
+using namespace top;
+using namespace top::xvm;
+
+struct xbench_contract_t {
+    const char* name;
+    const char* action;
+    const char* code;
+    const char* abi;        // nullptr means no abi
+    uint8_t     arg_num;    // 1 takes the tx index, more take uint64 and string args in turn
+};
+
+// takes any number of args, sums the numbers and the string lengths
+static const char s_args_code[] = R"(
+function bench_args(...)
+    local sum = 0
+    for _, v in ipairs({...}) do
+        if type(v) == "string" then
+            sum = sum + #v
+        else
+            sum = sum + v
+        end
+    end
+    return sum
+end
+)";
+
+// compute only, string property writes, map property writes, all of them, and the action
+// arg decoding of 12 mixed args without and with abi
+static const xbench_contract_t s_corpus[] = {
+    { "compute", "bench_compute", R"(
+function bench_compute(n)
+    local sum = 0
+    for i = 1, 200 do
+        sum = sum + (n * i) % 7
+    end
+    return sum
+end
+)", nullptr, 1 },
+    { "string", "bench_string", R"(
+function init()
+    create_key("counter")
+end
+
+function bench_string(n)
+    set_key("counter", tostring(n))
+    return get_key("counter")
+end
+)", nullptr, 1 },
+    { "map", "bench_map", R"(
+function init()
+    hcreate("balances")
+end
+
+function bench_map(n)
+    local field = tostring(n % 64)
+    hset("balances", field, tostring(n))
+    return hget("balances", field)
+end
+)", nullptr, 1 },
+    { "mixed", "bench_mixed", R"(
+function init()
+    create_key("counter")
+    hcreate("balances")
+end
+
+function bench_mixed(n)
+    local s = ""
+    for i = 1, 16 do
+        s = s .. tostring(n + i)
+    end
+    set_key("counter", s)
+    hset("balances", tostring(n % 64), s)
+end
+)", nullptr, 1 },
+};
+
+int main(int argc, char* argv[]) {
+    uint64_t tx_num = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    uint64_t contract_num = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 16;
+    auto const corpus_size = sizeof(s_corpus) / sizeof(s_corpus[0]);
+    if (contract_num == 0) {
+        contract_num = corpus_size;
+    }
+
+    xvm_bench_chain chain;
+    xvm_service service;
+    std::vector<std::string> addresses;
+    for (uint64_t i = 0; i < contract_num; i++) {
+        auto const & contract = s_corpus[i % corpus_size];
+        auto address = std::string("T-3-xvm-bench-") + contract.name + "-" + std::to_string(i);
+        auto trace = chain.publish(service, address, contract.code, 0, contract.abi == nullptr ? "" : contract.abi);
+        if (trace->m_errno != enum_xvm_error_code::ok) {
+            std::printf("{\"error\":\"publish %s: %s\"}\n", address.c_str(), trace->m_errmsg.c_str());
+            return 1;
+        }
+        addresses.push_back(address);
+    }
+
+    // only the calls are measured, the first call of each contract creates its engine (cold)
+    service.m_stats.set_enabled(true);
+    service.m_stats.reset();
+    for (uint64_t i = 0; i < tx_num; i++) {
+        auto const contract_idx = i % contract_num;
+        auto const & contract = s_corpus[contract_idx % corpus_size];
+        auto param = contract.arg_num == 1 ? xvm_bench_chain::uint64_param({i}) : xvm_bench_chain::mixed_param(i, contract.arg_num);
+        chain.call(service, addresses[contract_idx], contract.action, param);
+    }
+    std::printf("%s\n", service.m_stats.dump().c_str());
+    return 0;
+}
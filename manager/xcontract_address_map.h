@@ -32,6 +32,20 @@ public:
         return address;
     }
 
+    /**
+     * @brief the only monitor address other than itself that cluster_address can match,
+     *        i.e. cluster_address without its table id suffix
+     *
+     * @param cluster_address
+     * @return common::xaccount_address_t, empty if cluster_address is too short to carry a table id
+     */
+    static common::xaccount_address_t base_address(common::xaccount_address_t const &cluster_address) {
+        if (cluster_address.value().size() <= TOP_ADDR_TABLE_ID_SUFFIX_LENGTH) {
+            return common::xaccount_address_t{};
+        }
+        return common::xaccount_address_t{cluster_address.value().substr(0, cluster_address.value().size() - TOP_ADDR_TABLE_ID_SUFFIX_LENGTH)};
+    }
+
     /**
      * @brief check if monitor_address is prefix of cluster_address
      *
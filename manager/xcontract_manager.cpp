@@ -19,6 +19,7 @@
 #include "xmbus/xevent_timer.h"
 #include "xvm/manager/xcontract_address_map.h"
 #include "xvm/manager/xmessage_ids.h"
+#include "xvm/xserialization/xmsgpack_memo.h"
 #include "xvm/xsystem_contracts/tcc/xrec_proposal_contract.h"
 #include "xvm/xsystem_contracts/deploy/xcontract_deploy.h"
 #include "xvm/xsystem_contracts/xelection/xrec/xrec_elect_archive_contract.h"
@@ -38,8 +39,10 @@
 #include "xvm/xsystem_contracts/xreward/xzec_workload_contract.h"
 #include "xvm/xsystem_contracts/xslash/xzec_slash_info_contract.h"
 #include "xvm/xsystem_contracts/xslash/xtable_slash_info_collection_contract.h"
+#include "xvm/xvm_foreign_read_cache.h"
 #include "xvm/xvm_service.h"
 
+#include <algorithm>
 #include <cinttypes>
 
 NS_BEG2(top, contract)
@@ -79,6 +82,14 @@ void xtop_contract_manager::instantiate_sys_contracts() {
     XREGISTER_CONTRACT(top::xvm::xcontract::xtable_slash_info_collection_contract, sys_contract_sharding_slash_info_addr, network_id);
     XREGISTER_CONTRACT(top::xvm::xcontract::xzec_slash_info_contract, sys_contract_zec_slash_info_addr, network_id);
     XREGISTER_CONTRACT(top::xvm::system_contracts::reward::xtable_reward_claiming_contract_t, sys_contract_sharding_reward_claiming_addr, network_id);
+
+    // the msgpack memo is off unless a budget is configured for it
+    uint64_t memo_budget{0};
+    if (config::xconfig_register_t::get_instance().get(std::string(XMSGPACK_MEMO_BUDGET_CONFIG), memo_budget) && memo_budget > 0) {
+        auto & memo = xvm::serialization::xmsgpack_memo_t::instance();
+        memo.set_budget(static_cast<std::size_t>(memo_budget));
+        memo.set_enabled(true);
+    }
 }
 
 #undef XREGISTER_CONTRACT
@@ -167,6 +178,7 @@ void xtop_contract_manager::clear() {
         delete pair.second;
     }
     m_map.clear();
+    m_block_index.clear();
 
     m_contract_inst_map.clear();
 }
@@ -204,6 +216,7 @@ void xtop_contract_manager::process_event(const xevent_ptr_t & e) {
         } else {
             do_new_vnode(event);
         }
+        rebuild_block_index();
         event->notify();
         break;
     }
@@ -235,6 +248,7 @@ void xtop_contract_manager::do_destory_vnode(const xevent_vnode_ptr_t & e) {
 void xtop_contract_manager::do_on_block(const xevent_ptr_t & e) {
     xdbg("[xtop_contract_manager::do_on_block] map size %d", m_map.size());
 
+    xblock_t * block{};
     if (e->major_type == xevent_major_type_chain_timer) {
         assert(std::dynamic_pointer_cast<xevent_chain_timer_t>(e) != nullptr);
         auto const event = std::static_pointer_cast<xevent_chain_timer_t>(e);
@@ -245,13 +259,63 @@ void xtop_contract_manager::do_on_block(const xevent_ptr_t & e) {
         }
 
         m_latest_timer = height;  // record
+        block = (xblock_t *)event->time_block;
+    } else if (e->minor_type == xevent_store_t::type_block_to_db) {
+        block = ((xevent_store_block_to_db_t *)e.get())->block.get();
+        if (block != nullptr) {
+            xvm::xvm_foreign_read_cache::instance().invalidate(block->get_block_owner(), block->get_height());
+        }
+    }
+    if (block == nullptr) {
+        return;
+    }
+
+    // only the role contexts monitoring the owner, or its table prefix, or broadcasting its blocks act on it
+    std::vector<xrole_context_t *> contexts;
+    auto collect = [&](common::xaccount_address_t const & key) {
+        auto it = m_block_index.find(key);
+        if (it == m_block_index.end()) {
+            return;
+        }
+        for (auto * rc : it->second) {
+            if (std::find(contexts.begin(), contexts.end(), rc) == contexts.end()) {
+                contexts.push_back(rc);
+            }
+        }
+    };
+    auto const owner = common::xaccount_address_t{block->get_block_owner()};
+    collect(owner);
+    auto const base = xcontract_address_map_t::base_address(owner);
+    if (base.has_value()) {
+        collect(base);
     }
+    XMETRICS_COUNTER_INCREMENT("xvm_contract_manager_block_event", 1);
+    XMETRICS_COUNTER_INCREMENT("xvm_contract_manager_block_event_contexts_visited", contexts.size());
 
     bool event_broadcasted{false};
+    for (auto * rc : contexts) {
+        rc->on_block(e, event_broadcasted);
+    }
+}
+
+void xtop_contract_manager::rebuild_block_index() {
+    m_block_index.clear();
     for (auto & pair : m_map) { // m_map : std::unordered_map<common::xaccount_address_t, xrole_map_t *>
-        // auto const & account_address = top::get<common::xaccount_address_t const>(pair);
         for (auto & pr : *(pair.second)) {  // using xrole_map_t = std::unordered_map<xvnetwork_driver_face_t *, xrole_context_t *>;
-            pr.second->on_block(e, event_broadcasted);
+            auto * rc = top::get<xrole_context_t *>(pr);
+            auto * info = rc->contract_info();
+            auto add = [&](common::xaccount_address_t const & key) {
+                auto & contexts = m_block_index[key];
+                if (contexts.empty() || contexts.back() != rc) {
+                    contexts.push_back(rc);
+                }
+            };
+            for (auto const & monitor : info->monitor_map) {
+                add(monitor.first);
+            }
+            if (info->has_broadcasts()) {
+                add(common::xaccount_address_t{data::account_address_to_block_address(info->address)});
+            }
         }
     }
 }
@@ -324,8 +388,7 @@ void xtop_contract_manager::setup_chain(common::xaccount_address_t const & contr
 
     xaccount_context_t ac(contract_cluster_address.value(), store);
 
-    xvm::xvm_service s;
-    s.deal_transaction(tx, &ac);
+    vm_service().deal_transaction(tx, &ac);
 
     store::xtransaction_result_t result;
     ac.get_transaction_result(result);
@@ -370,6 +433,19 @@ base::xvnodesrv_t * xtop_contract_manager::get_node_service() const noexcept {
     return m_nodesvr_ptr;
 }
 
+xvm::xvm_service & xtop_contract_manager::vm_service() {
+    std::lock_guard<std::mutex> lock(m_vm_service_lock);
+    auto & service = m_vm_services[std::this_thread::get_id()];
+    if (service == nullptr) {
+        // never pruned, one per calling thread, so each keeps a small engine cache
+        service.reset(new xvm::xvm_service(XCONTRACT_MANAGER_VM_SERVICE_CACHE_BUDGET));
+        XMETRICS_COUNTER_INCREMENT("xvm_contract_manager_vm_service_create", 1);
+    } else {
+        XMETRICS_COUNTER_INCREMENT("xvm_contract_manager_vm_service_reuse", 1);
+    }
+    return *service;
+}
+
 static void get_election_result_property_data(observer_ptr<store::xstore_face_t const> store,
                                               common::xaccount_address_t const & contract_address,
                                               xjson_format_t const json_format,
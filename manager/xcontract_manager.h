@@ -16,6 +16,7 @@
 #include "xstore/xstore_face.h"
 #include "xvm/manager/xcontract_register.h"
 #include "xvm/manager/xrole_context.h"
+#include "xvm/xvm_service.h"
 #include "xvnetwork/xmessage_callback_hub.h"
 #include "xvnetwork/xvhost_face.h"
 #include "xblockstore/xsyncvstore_face.h"
@@ -24,10 +25,13 @@
 #include <list>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 NS_BEG2(top, contract)
 
+#define XCONTRACT_MANAGER_VM_SERVICE_CACHE_BUDGET   (4 * 1024 * 1024)   // engine cache of each per thread vm service
+
 using namespace top::base;
 using namespace top::mbus;
 using namespace top::common;
@@ -118,6 +122,13 @@ public:
      * @return base::xvnodesrv_t*
      */
     base::xvnodesrv_t * get_node_service() const noexcept;
+    /**
+     * @brief Get the vm service of the calling thread, it lives as long as the manager
+     *        so contracts called directly (without consensus) reuse it instead of building one per call
+     *
+     * @return xvm::xvm_service&
+     */
+    xvm::xvm_service & vm_service();
     /**
      * @brief Get the thread object
      *
@@ -222,13 +233,23 @@ private:
      * @param store store
      */
     void setup_chain(common::xaccount_address_t const & contract_cluster_address, xstore_face_t * store);
+    /**
+     * @brief index the role contexts in m_map by the block owners they act on,
+     *        called whenever m_map changes
+     *
+     */
+    void rebuild_block_index();
 
     std::unordered_map<common::xaccount_address_t, xrole_map_t *>    m_map;
+    // monitored address, or block address of a broadcasting contract -> the role contexts acting on its blocks
+    std::unordered_map<common::xaccount_address_t, std::vector<xrole_context_t *>> m_block_index;
     xcontract_register_t                                             m_contract_register;
     observer_ptr<xstore_face_t>                                      m_store{};
     xobject_ptr_t<store::xsyncvstore_t>                              m_syncstore{};
     std::unordered_map<common::xaccount_address_t, xcontract_base *> m_contract_inst_map;
     base::xrwlock_t                                                  m_rwlock;
+    std::mutex                                                       m_vm_service_lock;
+    std::unordered_map<std::thread::id, std::unique_ptr<xvm::xvm_service>> m_vm_services;
 
     static base::xvnodesrv_t                                         *m_nodesvr_ptr;
 
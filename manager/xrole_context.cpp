@@ -7,7 +7,9 @@
 #include "xchain_timer/xchain_timer_face.h"
 #include "xmbus/xevent_store.h"
 #include "xvm/manager/xcontract_address_map.h"
+#include "xvm/manager/xcontract_manager.h"
 #include "xvm/manager/xmessage_ids.h"
+#include "xvm/xcontract/xcontract_pool.h"
 #include "xvm/xvm_service.h"
 #include "xmbus/xevent_timer.h"
 
@@ -87,15 +89,7 @@ void xrole_context_t::on_block(const xevent_ptr_t & e, bool & event_broadcasted)
     }
 
     if (m_contract_info->has_block_monitors()) {
-        xblock_monitor_info_t * info = m_contract_info->find(address);
-        if (info == nullptr) {
-            for (auto & pair : m_contract_info->monitor_map) {
-                if (xcontract_address_map_t::match(address, pair.first)) {
-                    info = pair.second;
-                    break;
-                }
-            }
-        }
+        xblock_monitor_info_t * info = m_contract_info->find(address, xcontract_address_map_t::base_address(address));
 
         if (info != nullptr) {
             bool do_call{false};
@@ -264,10 +258,7 @@ void xrole_context_t::call_contract(const std::string & action_params, uint64_t
                   account->account_send_trans_number(),
                   timestamp);
         } else {
-            xvm::xvm_service s;
-            xaccount_context_t ac(address.value(), m_store.get());
-            auto trace = s.deal_transaction(tx, &ac);
-            xinfo("[xrole_context_t] call_contract in no_consensus mode with return code : %d", (int)trace->m_errno);
+            call_contract_direct(tx, address);
         }
     }
 }
@@ -299,13 +290,26 @@ void xrole_context_t::call_contract(const std::string & action_params, uint64_t
               account->account_send_trans_number(),
               timestamp);
     } else {
-        xvm::xvm_service s;
-        xaccount_context_t ac(address.value(), m_store.get());
-        auto trace = s.deal_transaction(tx, &ac);
-        xinfo("[xrole_context_t] call_contract in no_consensus mode with return code : %d", (int)trace->m_errno);
+        call_contract_direct(tx, address);
     }
 }
 
+void xrole_context_t::call_contract_direct(const xtransaction_ptr_t & tx, common::xaccount_address_t const & address) {
+    auto & service = xtop_contract_manager::instance().vm_service();
+    // direct calls run native contracts, which come from the calling thread's contract pool
+    auto const hit_count = xvm::xcontract::xcontract_pool::hit_count();
+    auto const clone_count = xvm::xcontract::xcontract_pool::clone_count();
+    xaccount_context_t ac(address.value(), m_store.get());
+    auto trace = service.deal_transaction(tx, &ac);
+    XMETRICS_COUNTER_INCREMENT("xvm_direct_call", 1);
+    XMETRICS_COUNTER_INCREMENT("xvm_direct_call_contract_pool_hit", xvm::xcontract::xcontract_pool::hit_count() - hit_count);
+    XMETRICS_COUNTER_INCREMENT("xvm_direct_call_contract_pool_clone", xvm::xcontract::xcontract_pool::clone_count() - clone_count);
+    xinfo("[xrole_context_t] call_contract in no_consensus mode with return code : %d, contract pool hit %" PRIu64 " clone %" PRIu64,
+          (int)trace->m_errno,
+          xvm::xcontract::xcontract_pool::hit_count(),
+          xvm::xcontract::xcontract_pool::clone_count());
+}
+
 void xrole_context_t::broadcast(const xblock_ptr_t & block_ptr, common::xnode_type_t types) {
     assert(block_ptr != nullptr);
     base::xstream_t stream(base::xcontext_t::instance());
@@ -53,6 +53,13 @@ public:
      */
     bool valid_call(const uint64_t onchain_timer_round);
 
+    /**
+     * @brief Get the contract info of the role context
+     *
+     * @return xcontract_info_t*
+     */
+    xcontract_info_t * contract_info() const noexcept { return m_contract_info; }
+
 protected:
     /**
      * @brief call the contract
@@ -71,6 +78,13 @@ protected:
      * @param table_id
      */
     void call_contract(const uint64_t onchain_timer_round, xblock_monitor_info_t * info, const uint64_t block_timestamp, uint16_t table_id);
+    /**
+     * @brief execute the transaction locally without consensus, on the vm service of the calling thread
+     *
+     * @param tx the transaction
+     * @param address the target address
+     */
+    void call_contract_direct(const xtransaction_ptr_t & tx, common::xaccount_address_t const & address);
     /**
      * @brief call the contract
      *
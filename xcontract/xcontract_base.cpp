@@ -21,6 +21,10 @@ void xcontract_base::set_contract_helper(shared_ptr<xcontract_helper> contract_h
     m_contract_helper = contract_helper;
 }
 
+void xcontract_base::reset() {
+    m_contract_helper.reset();
+}
+
 string xcontract_base::GET_EXEC_ACCOUNT() const {
     return m_contract_helper->get_source_account();
 }
@@ -284,6 +288,28 @@ void xcontract_base::MAP_COPY_GET(const std::string& key, std::map<std::string,
     return m_contract_helper->map_copy_get(key, map, addr);
 }
 
+void xcontract_base::MAP_FOR_EACH(const std::string& key, xmap_visitor_t const & visitor, const std::string& addr) const {
+    m_contract_helper->map_for_each(key, "", "", visitor, addr);
+}
+
+void xcontract_base::MAP_FOR_EACH_RANGE(const std::string& key, const std::string& first, const std::string& last, xmap_visitor_t const & visitor, const std::string& addr) const {
+    m_contract_helper->map_for_each(key, first, last, visitor, addr);
+}
+
+bool xcontract_base::MAP_FIND_IF(const std::string& key, xmap_visitor_t const & pred, std::string& field, std::string& value, const std::string& addr) const {
+    bool found{false};
+    m_contract_helper->map_for_each(key, "", "", [&](const std::string& f, const std::string& v) {
+        if (!pred(f, v)) {
+            return true;
+        }
+        field = f;
+        value = v;
+        found = true;
+        return false;
+    }, addr);
+    return found;
+}
+
 int32_t xcontract_base::MAP_SIZE(const string& key) {
     return m_contract_helper->map_size(key);
 }
@@ -12,6 +12,7 @@
 #include "xcommon/xaddress.h"
 #include "xcommon/xlogic_time.h"
 #include "xvm/xcontract_helper.h"
+#include "xvm/xcontract/xproperty_handle.h"
 #include "xvm/xvm_context.h"
 
 NS_BEG3(top, xvm, xcontract)
@@ -98,6 +99,13 @@ public:
      */
     virtual void set_contract_helper(shared_ptr<xcontract_helper> contract_helper) final;
 
+    /**
+     * @brief drop the per transaction state before the instance is pooled for reuse,
+     *        contracts keeping their own per transaction members override it
+     *
+     */
+    virtual void reset();
+
     /**
      * @brief Get the exec account object
      *
@@ -433,6 +441,54 @@ public:
      */
     virtual void MAP_COPY_GET(const std::string& key, std::map<std::string, std::string> & map, const std::string& addr = "") const;
 
+    /**
+     * @brief typed handle of a string property or a map field, decoded once per execution
+     *
+     * @tparam T  the type serialized in the property
+     * @param key  the property key
+     * @param field  the map field, empty for a string property
+     * @param addr  the addr the property belong to
+     * @return xproperty_handle<T>  the handle
+     */
+    template <typename T>
+    xproperty_handle<T> PROPERTY(const std::string& key, const std::string& field = "", const std::string& addr = "") const {
+        return xproperty_handle<T>{m_contract_helper.get(), key, field, addr};
+    }
+
+    /**
+     * @brief visit the map property field by field. the map of another contract is visited in
+     *        the foreign read cache without a copy, the map of this contract is still copied once
+     *        as MAP_COPY_GET does
+     *
+     * @param key  the map property key
+     * @param visitor  called with each field and value in order, returns false to stop
+     * @param addr  the addr the map property belong to
+     */
+    virtual void MAP_FOR_EACH(const std::string& key, xmap_visitor_t const & visitor, const std::string& addr = "") const;
+
+    /**
+     * @brief visit the fields in [first, last) of the map property
+     *
+     * @param key  the map property key
+     * @param first  the first field to visit, empty for the beginning
+     * @param last  the field to stop before, empty for the end
+     * @param visitor  called with each field and value in order, returns false to stop
+     * @param addr  the addr the map property belong to
+     */
+    virtual void MAP_FOR_EACH_RANGE(const std::string& key, const std::string& first, const std::string& last, xmap_visitor_t const & visitor, const std::string& addr = "") const;
+
+    /**
+     * @brief find the first field of the map property matching the predicate
+     *
+     * @param key  the map property key
+     * @param pred  called with each field and value in order until it returns true
+     * @param field  the matched field
+     * @param value  the matched value
+     * @param addr  the addr the map property belong to
+     * @return bool  whether a field matches
+     */
+    virtual bool MAP_FIND_IF(const std::string& key, xmap_visitor_t const & pred, std::string& field, std::string& value, const std::string& addr = "") const;
+
     /**
      * @brief the size of the map property
      *
@@ -3,7 +3,9 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #pragma once
+#include <cstdint>
 #include <string>
+#include <type_traits>
 #include "xbasic/xns_macro.h"
 #include "xvm/xvm_context.h"
 #include "xvm/xerror/xvm_error.h"
@@ -60,6 +62,25 @@ auto apply(Func&& func, Obj&& obj, Tuple&& tuple) ->
                         temp);
 }
 
+/**
+ * @brief FNV-1a hash of the action name, evaluated at compile time for the case labels
+ *
+ * @param name  the action name
+ * @param hash  the hash of the characters before name
+ * @return constexpr uint64_t  the hash
+ */
+constexpr uint64_t action_name_hash(const char* name, uint64_t hash = 14695981039346656037ULL) {
+    return *name == '\0' ? hash : action_name_hash(name + 1, (hash ^ static_cast<uint8_t>(*name)) * 1099511628211ULL);
+}
+
+inline uint64_t action_name_hash(const std::string& name) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (auto c : name) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ULL;
+    }
+    return hash;
+}
+
 template<typename T>
 T unpack( base::xstream_t& stream ) {
     T result;
@@ -68,16 +89,31 @@ T unpack( base::xstream_t& stream ) {
 }
 
 
+// the unpacked arg is moved into the callee, unless the parameter is a non-const lvalue reference
+template<typename Arg, typename T>
+using action_arg_t = typename std::conditional<std::is_lvalue_reference<Arg>::value && !std::is_const<typename std::remove_reference<Arg>::type>::value, T&, T&&>::type;
+
+template<typename Arg, typename T>
+action_arg_t<Arg, T> move_arg(T& value) {
+    return static_cast<action_arg_t<Arg, T>>(value);
+}
+
+template<typename T, typename U, typename Callable, typename Tuple, typename... Args, size_t... index>
+void invoke_action(T* obj, Callable&& callable, Tuple& args, void (U::*)(Args...), seq<index...>) {
+    callable(obj, move_arg<Args>(std::get<index>(args))...);
+}
+
 template<typename T, typename U, typename Callable, typename... Args>
-void do_action(T* obj, top::base::xstream_t& stream, Callable&& callable, void (U::*)(Args...))
+void do_action(T* obj, top::base::xstream_t& stream, Callable&& callable, void (U::*func)(Args...))
 {
 	auto args = unpack<std::tuple<typename std::decay<Args>::type...>>(stream);
-    apply(callable, obj, args);
+    invoke_action(obj, callable, args, func, typename gens<sizeof...(Args)>::type{});
 }
 
 
 /**
- * @brief define exec function in contract
+ * @brief define exec function in contract, the actions are dispatched by a switch on the
+ *        hash of the name, so two actions with the same hash fail to compile
  *
  */
 #define BEGIN_CONTRACT_WITH_PARAM(class_name) void exec(top::xvm::xvm_context* vm_ctx) override {\
@@ -85,23 +121,30 @@ void do_action(T* obj, top::base::xstream_t& stream, Callable&& callable, void (
     const auto& params = vm_ctx->m_current_action.get_action_param();\
     xcontract_base::set_contract_helper(vm_ctx->m_contract_helper);\
     base::xstream_t stream(base::xcontext_t::instance(), (uint8_t*)params.data(), params.size());\
+    switch (top::xvm::xcontract::action_name_hash(func_name)) {\
     CONTRACT_FUNCTION_PARAM(class_name, setup);\
-    CONTRACT_FUNCTION_PARAM(class_name, on_event)
+    CONTRACT_FUNCTION_PARAM(class_name, on_event);
 
-#define END_CONTRACT_WITH_PARAM throw top::xvm::xvm_error{top::xvm::enum_xvm_error_code::enum_vm_no_func_find, "no exec function find"};\
+#define END_CONTRACT_WITH_PARAM default:\
+        break;\
+    }\
+    throw top::xvm::xvm_error{top::xvm::enum_xvm_error_code::enum_vm_no_func_find, "no exec function find"};\
 }
 
 #define CONTRACT_FUNCTION_PARAM(class_name, func)  CALL_FUNC_PARAM(class_name, func_name, func, params)
 
 /**
- * @brief call the func in class with the param
+ * @brief call the func in class with the param, the name is compared too as
+ *        an unknown action may hash to the same case
  *
  */
 #define CALL_FUNC_PARAM(class_name, func_name, func, params) \
-if(func_name == #func) {\
-    auto fn = std::mem_fn(&class_name::func);\
-    do_action(this, stream, fn, &class_name::func);\
-    return;\
-}
+case top::xvm::xcontract::action_name_hash(#func):\
+    if(func_name == #func) {\
+        auto fn = std::mem_fn(&class_name::func);\
+        do_action(this, stream, fn, &class_name::func);\
+        return;\
+    }\
+    break
 
 NS_END3
@@ -0,0 +1,62 @@
+// Copyright (c) 2017-2018 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "xvm/xcontract/xcontract_pool.h"
+#include "xmetrics/xmetrics.h"
+
+#include <unordered_map>
+
+NS_BEG3(top, xvm, xcontract)
+
+// prototype -> idle instance, one is enough as contracts on a thread run one at a time
+using xcontract_pool_map_t = std::unordered_map<xcontract_base*, std::unique_ptr<xcontract_base>>;
+
+static xcontract_pool_map_t& thread_pool() {
+    static thread_local xcontract_pool_map_t pool;
+    return pool;
+}
+
+struct xcontract_pool_count_t {
+    uint64_t hit{0};
+    uint64_t clone{0};
+};
+
+static xcontract_pool_count_t& thread_count() {
+    static thread_local xcontract_pool_count_t count;
+    return count;
+}
+
+std::unique_ptr<xcontract_base> xcontract_pool::take(xcontract_base* prototype) {
+    auto & pool = thread_pool();
+    auto iter = pool.find(prototype);
+    if (iter != pool.end() && iter->second != nullptr) {
+        XMETRICS_COUNTER_INCREMENT("xvm_contract_pool_hit", 1);
+        thread_count().hit++;
+        return std::move(iter->second);
+    }
+    XMETRICS_COUNTER_INCREMENT("xvm_contract_pool_clone", 1);
+    thread_count().clone++;
+    return std::unique_ptr<xcontract_base>{prototype->clone()};
+}
+
+void xcontract_pool::put(xcontract_base* prototype, std::unique_ptr<xcontract_base> contract) {
+    if (contract == nullptr) {
+        return;
+    }
+    contract->reset();
+    auto & idle = thread_pool()[prototype];
+    if (idle == nullptr) {
+        idle = std::move(contract);
+    }
+}
+
+uint64_t xcontract_pool::hit_count() {
+    return thread_count().hit;
+}
+
+uint64_t xcontract_pool::clone_count() {
+    return thread_count().clone;
+}
+
+NS_END3
@@ -0,0 +1,45 @@
+// Copyright (c) 2017-2018 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "xvm/xcontract/xcontract_base.h"
+
+NS_BEG3(top, xvm, xcontract)
+
+/**
+ * @brief per thread pool of the instances cloned from the registered native contracts
+ *
+ */
+class xcontract_pool {
+public:
+    /**
+     * @brief take an idle instance of the prototype from the calling thread's pool,
+     *        clone a new one if none is idle (the first call, or a reentrant one)
+     *
+     * @param prototype  the registered contract, lives as long as the process
+     * @return std::unique_ptr<xcontract_base>  the instance
+     */
+    static std::unique_ptr<xcontract_base> take(xcontract_base* prototype);
+
+    /**
+     * @brief reset the instance and give it back to the calling thread's pool
+     *
+     * @param prototype  the contract the instance is taken for
+     * @param contract  the instance
+     */
+    static void put(xcontract_base* prototype, std::unique_ptr<xcontract_base> contract);
+
+    /**
+     * @brief the instances the calling thread took from its pool, and the ones it had to clone
+     *
+     */
+    static uint64_t hit_count();
+    static uint64_t clone_count();
+};
+
+NS_END3
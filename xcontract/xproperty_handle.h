@@ -0,0 +1,120 @@
+// Copyright (c) 2017-2018 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <typeinfo>
+
+#include "xbase/xcontext.h"
+#include "xbase/xmem.h"
+#include "xvm/xcontract_helper.h"
+#include "xvm/xerror/xvm_error.h"
+
+NS_BEG3(top, xvm, xcontract)
+
+template <typename T>
+class xdecoded_property_t : public xdecoded_property_face_t {
+public:
+    std::type_info const & type() const noexcept override {
+        return typeid(T);
+    }
+
+    std::string encode() override {
+        base::xstream_t stream(base::xcontext_t::instance());
+        value.serialize_to(stream);
+        return std::string((char *)stream.data(), stream.size());
+    }
+
+    T value{};
+};
+
+/**
+ * @brief typed access to a string property or a map field holding a T serialized with
+ *        serialize_to / serialize_from. the value is decoded once per execution and shared
+ *        by all handles of the property, changes are encoded once when written back at the
+ *        end of the execution, or before the property is read raw
+ *
+ */
+template <typename T>
+class xproperty_handle {
+public:
+    /**
+     * @brief Construct a new property handle
+     *
+     * @param helper  the contract helper of the execution
+     * @param key  the property key
+     * @param field  the map field, empty for a string property
+     * @param addr  the addr the property belong to, only our own property can be changed
+     */
+    xproperty_handle(xcontract_helper* helper, std::string key, std::string field = "", std::string addr = "")
+      : m_helper{helper}, m_key{std::move(key)}, m_field{std::move(field)}, m_addr{std::move(addr)} {
+    }
+
+    /**
+     * @brief the decoded value, a default T if the property is empty or absent.
+     *        reading our own string property throws on a store error, as STRING_GET does
+     *
+     * @return T const&  valid until the property is written raw or the execution ends
+     */
+    T const & get() {
+        return decoded().value;
+    }
+
+    /**
+     * @brief the decoded value to change, it is written back to the property
+     *
+     * @return T&  valid until the property is written raw or the execution ends
+     */
+    T & mutate() {
+        if (!m_helper->is_self(m_addr)) {
+            throw xvm_error{enum_xvm_error_code::enum_vm_exception, "property " + m_key + " of " + m_addr + " is read only"};
+        }
+        auto & property = decoded();
+        property.dirty = true;
+        property.exist = true;
+        return property.value;
+    }
+
+    /**
+     * @brief whether the property holds a value
+     *
+     */
+    bool exist() {
+        return decoded().exist;
+    }
+
+private:
+    xdecoded_property_t<T> & decoded() {
+        auto property = m_helper->decoded_property(m_key, m_field, m_addr);
+        if (property == nullptr) {
+            std::unique_ptr<xdecoded_property_t<T>> value{new xdecoded_property_t<T>{}};
+            std::string bytes;
+            if (m_field.empty()) {
+                // a store error on our own property aborts the execution instead of decoding a default T
+                bytes = m_helper->is_self(m_addr) ? m_helper->string_get(m_key, m_addr) : m_helper->string_get2(m_key, m_addr);
+            } else {
+                m_helper->map_get2(m_key, m_field, bytes, m_addr);
+            }
+            if (!bytes.empty()) {
+                base::xstream_t stream(base::xcontext_t::instance(), (uint8_t *)bytes.data(), (uint32_t)bytes.size());
+                value->value.serialize_from(stream);
+                value->exist = true;
+            }
+            property = m_helper->put_decoded_property(m_key, m_field, m_addr, std::move(value));
+        } else if (property->type() != typeid(T)) {
+            throw xvm_error{enum_xvm_error_code::enum_vm_exception, "property " + m_key + " is decoded as another type"};
+        }
+        return static_cast<xdecoded_property_t<T> &>(*property);
+    }
+
+private:
+    xcontract_helper*   m_helper;
+    std::string         m_key;
+    std::string         m_field;
+    std::string         m_addr;
+};
+
+NS_END3
@@ -6,6 +6,10 @@
 #include "xvm/xerror/xvm_error.h"
 #include "xstore/xstore_error.h"
 #include "xchain_upgrade/xchain_upgrade_center.h"
+#include "xdata/xproperty.h"
+#include "xmetrics/xmetrics.h"
+
+#include <algorithm>
 
 using namespace top::data;
 
@@ -17,6 +21,22 @@ using store::xstore_success;
 using store::xaccount_property_not_create;
 using store::xaccount_property_map_field_not_create;
 
+static uint64_t collection_bytes(vector<string> const & values) {
+    uint64_t bytes{0};
+    for (auto const & value : values) {
+        bytes += value.size();
+    }
+    return bytes;
+}
+
+static uint64_t collection_bytes(std::map<string, string> const & values) {
+    uint64_t bytes{0};
+    for (auto const & value : values) {
+        bytes += value.first.size() + value.second.size();
+    }
+    return bytes;
+}
+
 xcontract_helper::xcontract_helper(xaccount_context_t* account_context, common::xnode_id_t const & contract_account, const string& exec_account)
 :m_account_context(account_context)
 ,m_contract_account(contract_account)
@@ -78,30 +98,77 @@ void xcontract_helper::create_transfer_tx(const string& grant_account, const uin
 
 
 void xcontract_helper::string_create(const string& key) {
+    xhost_call_scope_t scope(m_profile, "STRING_CREATE");
+    drop_decoded(key);
+    flush_key(key);
     if (m_account_context->string_create(key)) {
         throw xvm_error{enum_xvm_error_code::enum_vm_exception, "STRING_CREATE " + key + " error"};
     }
 }
 void xcontract_helper::string_set(const string& key, const string& value, bool native) {
-    if (m_account_context->string_set(key, value, native)) {
-        throw xvm_error{enum_xvm_error_code::enum_vm_exception, "STRING_SET " + key + " error"};
+    xhost_call_scope_t scope(m_profile, "STRING_SET", key.size() + value.size());
+    drop_decoded(key);
+    if (!write_checked(key, native)) {
+        flush_key(key);
+        if (m_account_context->string_set(key, value, native)) {
+            throw xvm_error{enum_xvm_error_code::enum_vm_exception, "STRING_SET " + key + " error"};
+        }
+        m_checked_writes[key] = native;
+        return;
     }
+    auto & property = buffer_property(key, false);
+    property.value.value = value;
+    property.value.native = native;
 }
 string xcontract_helper::string_get(const string& key, const std::string& addr) {
+    xhost_call_scope_t scope(m_profile, "STRING_GET");
+    auto property = buffered_property(key, addr, false);
+    if (property != nullptr) {
+        scope.add_bytes(property->value.value.size());
+        return property->value.value;
+    }
+    if (!is_self(addr)) {
+        auto value = foreign_string_get(key, addr);
+        if (value == nullptr) {
+            throw xvm_error{enum_xvm_error_code::enum_vm_exception, "STRING_GET " + key + " error"};
+        }
+        scope.add_bytes(value->size());
+        return *value;
+    }
     string value;
     if (m_account_context->string_get(key, value, addr)) {
         throw xvm_error{enum_xvm_error_code::enum_vm_exception, "STRING_GET " + key + " error"};
     }
+    scope.add_bytes(value.size());
     return value;
 }
 
 string xcontract_helper::string_get2(const string& key, const std::string& addr) {
+    xhost_call_scope_t scope(m_profile, "STRING_GET2");
+    auto property = buffered_property(key, addr, false);
+    if (property != nullptr) {
+        scope.add_bytes(property->value.value.size());
+        return property->value.value;
+    }
+    if (!is_self(addr)) {
+        auto value = foreign_string_get(key, addr);
+        if (value == nullptr) {
+            return {};
+        }
+        scope.add_bytes(value->size());
+        return *value;
+    }
     string value;
     m_account_context->string_get(key, value, addr);
+    scope.add_bytes(value.size());
     return value;
 }
 
 bool xcontract_helper::string_exist(const string& key, const std::string& addr) {
+    xhost_call_scope_t scope(m_profile, "STRING_EXIST");
+    if (buffered_property(key, addr, false) != nullptr) {
+        return true;
+    }
     string value;
     int32_t ret = m_account_context->string_get(key, value, addr);
     if (xaccount_property_not_create == ret) {
@@ -115,50 +182,61 @@ bool xcontract_helper::string_exist(const string& key, const std::string& addr)
 }
 
 void xcontract_helper::list_create(const string& key) {
+    xhost_call_scope_t scope(m_profile, "LIST_CREATE");
     if (m_account_context->list_create(key)) {
         throw xvm_error{enum_xvm_error_code::enum_vm_exception, "LIST_CREATE " + key + " error"};
     }
 }
 
 void xcontract_helper::list_push_back(const string& key, const string& value, bool native) {
+    xhost_call_scope_t scope(m_profile, "LIST_PUSH_BACK", key.size() + value.size());
     if (m_account_context->list_push_back(key, value, native)) {
         throw xvm_error{enum_xvm_error_code::enum_vm_exception, "LIST_PUSH_BACK  " + key + " error"};
     }
 }
 
 void xcontract_helper::list_push_front(const string& key, const string& value, bool native) {
+    xhost_call_scope_t scope(m_profile, "LIST_PUSH_FRONT", key.size() + value.size());
     if (m_account_context->list_push_front(key, value, native)) {
         throw xvm_error{enum_xvm_error_code::enum_vm_exception, "LIST_PUSH_FRONT " + key + " error"};
     }
 }
 
 void xcontract_helper::list_pop_back(const string& key, string& value, bool native) {
+    xhost_call_scope_t scope(m_profile, "LIST_POP_BACK");
     if (m_account_context->list_pop_back(key, value, native)) {
         throw xvm_error{enum_xvm_error_code::enum_vm_exception, "LIST_POP_BACK " + key + " error"};
     }
+    scope.add_bytes(value.size());
 }
 
 void xcontract_helper::list_pop_front(const string& key, string& value, bool native) {
+    xhost_call_scope_t scope(m_profile, "LIST_POP_FRONT");
     if (m_account_context->list_pop_front(key, value, native)) {
         throw xvm_error{enum_xvm_error_code::enum_vm_exception, key + " LIST_POP_FRONT " + key + " error"};
     }
+    scope.add_bytes(value.size());
 }
 
 void xcontract_helper::list_clear(const string& key, bool native) {
+    xhost_call_scope_t scope(m_profile, "LIST_CLEAR");
     if (m_account_context->list_clear(key, native)) {
         throw xvm_error{enum_xvm_error_code::enum_vm_exception, key + " LIST_CLEAR " + key + " error"};
     }
 }
 
 std::string xcontract_helper::list_get(const std::string& key, int32_t index, const std::string& addr) {
+    xhost_call_scope_t scope(m_profile, "LIST_GET");
     std::string value{};
     if (m_account_context->list_get(key, index, value, addr)) {
         throw xvm_error{enum_xvm_error_code::enum_vm_exception, "LIST_GET " + key + " error"};
     }
+    scope.add_bytes(value.size());
     return value;
 }
 
 int32_t xcontract_helper::list_size(const string& key, const std::string& addr) {
+    xhost_call_scope_t scope(m_profile, "LIST_SIZE");
     int32_t size;
     if (m_account_context->list_size(key, size, addr)) {
         throw xvm_error{enum_xvm_error_code::enum_vm_exception, "LIST_SIZE " + key + " error"};
@@ -167,14 +245,19 @@ int32_t xcontract_helper::list_size(const string& key, const std::string& addr)
 }
 
 vector<string> xcontract_helper::list_get_all(const string& key, const string& addr) {
+    xhost_call_scope_t scope(m_profile, "LIST_GET_ALL");
     vector<string> value_list{};
     if (m_account_context->list_get_all(key, value_list, addr)) {
         throw xvm_error{enum_xvm_error_code::enum_vm_exception, "LIST_GET_ALL " + key + " error"};
     }
+    if (m_profile != nullptr) {
+        scope.add_bytes(collection_bytes(value_list));
+    }
     return value_list;
 }
 
 bool xcontract_helper::list_exist(const string& key) {
+    xhost_call_scope_t scope(m_profile, "LIST_EXIST");
     vector<string> value_list{};
     int32_t ret = m_account_context->list_get_all(key, value_list);
     if (xaccount_property_not_create == ret) {
@@ -188,36 +271,94 @@ bool xcontract_helper::list_exist(const string& key) {
 }
 
 void xcontract_helper::map_create(const string& key) {
+    xhost_call_scope_t scope(m_profile, "MAP_CREATE");
+    drop_decoded(key);
+    flush_key(key);
     if (m_account_context->map_create(key)) {
         throw xvm_error{enum_xvm_error_code::enum_vm_exception, "MAP_CREATE " + key + " error"};
     }
 }
 
 string xcontract_helper::map_get(const string& key, const string& field, const std::string& addr) {
+    xhost_call_scope_t scope(m_profile, "MAP_GET");
+    auto field_value = buffered_field(key, field, addr);
+    if (field_value != nullptr) {
+        scope.add_bytes(field_value->value.size());
+        return field_value->value;
+    }
+    if (!is_self(addr)) {
+        auto value = foreign_field_get(key, field, addr);
+        if (value == nullptr) {
+            throw xvm_error{enum_xvm_error_code::enum_vm_exception, "MAP_GET " + key + " error"};
+        }
+        scope.add_bytes(value->size());
+        return *value;
+    }
     string value{};
     if (m_account_context->map_get(key, field, value, addr)) {
         throw xvm_error{enum_xvm_error_code::enum_vm_exception, "MAP_GET " + key + " error"};
     }
+    scope.add_bytes(value.size());
     return value;
 }
 
 int32_t xcontract_helper::map_get2(const string& key, const string& field, string& value, const std::string& addr) {
-    return m_account_context->map_get(key, field, value, addr);
+    xhost_call_scope_t scope(m_profile, "MAP_GET2");
+    auto field_value = buffered_field(key, field, addr);
+    if (field_value != nullptr) {
+        value = field_value->value;
+        scope.add_bytes(value.size());
+        return xstore_success;
+    }
+    auto ret = m_account_context->map_get(key, field, value, addr);
+    scope.add_bytes(value.size());
+    return ret;
 }
 
 void xcontract_helper::map_set(const string& key, const string& field, const string & value, bool native) {
-    if (m_account_context->map_set(key, field, value, native)) {
-        throw xvm_error{enum_xvm_error_code::enum_vm_exception, "MAP_SET " + key + " error"};
+    xhost_call_scope_t scope(m_profile, "MAP_SET", key.size() + field.size() + value.size());
+    drop_decoded(key, &field);
+    if (!write_checked(key, native)) {
+        flush_key(key);
+        if (m_account_context->map_set(key, field, value, native)) {
+            throw xvm_error{enum_xvm_error_code::enum_vm_exception, "MAP_SET " + key + " error"};
+        }
+        m_checked_writes[key] = native;
+        return;
     }
+    auto & property = buffer_property(key, true);
+    auto iter = property.field_values.find(field);
+    if (iter == property.field_values.end()) {
+        property.fields.push_back(field);
+        iter = property.field_values.emplace(field, xbuffered_value_t{}).first;
+    }
+    iter->second.value = value;
+    iter->second.native = native;
 }
 
 void xcontract_helper::map_remove(const string& key, const string& field, bool native) {
+    xhost_call_scope_t scope(m_profile, "MAP_REMOVE");
+    drop_decoded(key, &field);
+    // removes are rare, drop the buffered set and remove in place so the errors stay the same
+    auto iter = m_buffer.find(key);
+    if (iter != m_buffer.end() && iter->second.is_map && iter->second.field_values.erase(field) != 0) {
+        auto & fields = iter->second.fields;
+        fields.erase(std::find(fields.begin(), fields.end(), field));
+        string value;
+        if (m_account_context->map_get(key, field, value) != xstore_success) {
+            return;
+        }
+    }
     if (m_account_context->map_remove(key, field, native)) {
         throw xvm_error{enum_xvm_error_code::enum_vm_exception, "MAP_REMOVE " + key + " error"};
     }
 }
 
 int32_t xcontract_helper::map_size(const string& key, const std::string& addr) {
+    xhost_call_scope_t scope(m_profile, "MAP_SIZE");
+    if (is_self(addr)) {
+        flush_key(key);
+    }
     int32_t size{0};
     if (m_account_context->map_size(key, size, addr)) {
         throw xvm_error{enum_xvm_error_code::enum_vm_exception, "MAP_SIZE " + key + " error"};
@@ -226,13 +367,64 @@ int32_t xcontract_helper::map_size(const string& key, const std::string& addr) {
 }
 
 void xcontract_helper::map_copy_get(const std::string & key, std::map<std::string, std::string> & map, const std::string& addr) {
-    if (m_account_context->map_copy_get(key, map, addr)) {
-        throw xvm_error{enum_xvm_error_code::enum_vm_exception, "MAP_COPY_GET " + key + " error"};
+    xhost_call_scope_t scope(m_profile, "MAP_COPY_GET");
+    if (is_self(addr)) {
+        flush_key(key);
+        if (m_account_context->map_copy_get(key, map, addr)) {
+            throw xvm_error{enum_xvm_error_code::enum_vm_exception, "MAP_COPY_GET " + key + " error"};
+        }
+    } else {
+        auto cached = foreign_map_copy_get(key, addr);
+        if (cached == nullptr) {
+            throw xvm_error{enum_xvm_error_code::enum_vm_exception, "MAP_COPY_GET " + key + " error"};
+        }
+        map = *cached;
+    }
+    if (m_profile != nullptr) {
+        scope.add_bytes(collection_bytes(map));
     }
 }
 
 
+void xcontract_helper::map_for_each(const std::string& key, const std::string& first, const std::string& last, xmap_visitor_t const & visitor, const std::string& addr) {
+    xhost_call_scope_t scope(m_profile, "MAP_FOR_EACH");
+    // the account context has no iterator, a map of our own is copied out as MAP_COPY_GET does.
+    // a map of another account is visited in the foreign read cache
+    std::map<std::string, std::string> own;
+    xforeign_map_ptr_t foreign;
+    const std::map<std::string, std::string>* map{&own};
+    if (is_self(addr)) {
+        flush_key(key);
+        if (m_account_context->map_copy_get(key, own, addr)) {
+            throw xvm_error{enum_xvm_error_code::enum_vm_exception, "MAP_FOR_EACH " + key + " error"};
+        }
+    } else {
+        foreign = foreign_map_copy_get(key, addr);
+        if (foreign == nullptr) {
+            throw xvm_error{enum_xvm_error_code::enum_vm_exception, "MAP_FOR_EACH " + key + " error"};
+        }
+        map = foreign.get();
+    }
+    if (!first.empty() && !last.empty() && last <= first) {
+        return;
+    }
+    auto iter = first.empty() ? map->begin() : map->lower_bound(first);
+    auto end = last.empty() ? map->end() : map->lower_bound(last);
+    for (; iter != end; ++iter) {
+        if (m_profile != nullptr) {
+            scope.add_bytes(iter->first.size() + iter->second.size());
+        }
+        if (!visitor(iter->first, iter->second)) {
+            break;
+        }
+    }
+}
+
 bool xcontract_helper::map_field_exist(const string& key, const string& field) {
+    xhost_call_scope_t scope(m_profile, "MAP_FIELD_EXIST");
+    if (buffered_field(key, field) != nullptr) {
+        return true;
+    }
     string value{};
     int32_t ret = m_account_context->map_get(key, field, value);
     if (xaccount_property_map_field_not_create == ret || xaccount_property_not_create == ret) {
@@ -246,6 +438,10 @@ bool xcontract_helper::map_field_exist(const string& key, const string& field) {
 }
 
 bool xcontract_helper::map_key_exist(const std::string& key) {
+    xhost_call_scope_t scope(m_profile, "MAP_KEY_EXIST");
+    if (buffered_property(key, "", true) != nullptr) {
+        return true;
+    }
     string field, value;
     int32_t ret = m_account_context->map_get(key, field, value);
     if (xaccount_property_not_create == ret) {
@@ -256,16 +452,28 @@ bool xcontract_helper::map_key_exist(const std::string& key) {
 }
 
 void xcontract_helper::map_clear(const std::string& key, bool native) {
+    xhost_call_scope_t scope(m_profile, "MAP_CLEAR");
+    drop_decoded(key);
+    flush_key(key);
     if (m_account_context->map_clear(key, native)) {
         throw xvm_error{enum_xvm_error_code::enum_vm_exception, "MAP_CLEAR " + key + " error"};
     }
 }
 
 void xcontract_helper::get_map_property(const std::string& key, std::map<std::string, std::string>& value, uint64_t height, const std::string& addr) {
+    xhost_call_scope_t scope(m_profile, "GET_MAP_PROPERTY");
+    if (is_self(addr)) {
+        flush_key(key);
+    }
     m_account_context->get_map_property(key, value, height, addr);
+    if (m_profile != nullptr) {
+        scope.add_bytes(collection_bytes(value));
+    }
 }
 
 bool xcontract_helper::map_property_exist(const std::string& key) {
+    xhost_call_scope_t scope(m_profile, "MAP_PROPERTY_EXIST");
+    flush_key(key);
     return m_account_context->map_property_exist(key) == 0;
 }
 
@@ -305,6 +513,218 @@ std::uint64_t  xcontract_helper::get_blockchain_height(const std::string & owner
     return m_account_context->get_blockchain_height(owner);
 }
 
+bool xcontract_helper::is_self(const std::string& addr) const {
+    return addr.empty() || addr == m_contract_account.value();
+}
+
+bool xcontract_helper::write_checked(const std::string& key, bool native) const {
+    auto iter = m_checked_writes.find(key);
+    return iter != m_checked_writes.end() && iter->second == native;
+}
+
+xcontract_helper::xbuffered_property_t & xcontract_helper::buffer_property(const std::string& key, bool is_map) {
+    auto iter = m_buffer.find(key);
+    if (iter != m_buffer.end() && iter->second.is_map != is_map) {
+        flush_key(key);
+        iter = m_buffer.end();
+    }
+    if (iter == m_buffer.end()) {
+        m_buffer_order.push_back(key);
+        iter = m_buffer.emplace(key, xbuffered_property_t{}).first;
+        iter->second.is_map = is_map;
+    }
+    return iter->second;
+}
+
+const xcontract_helper::xbuffered_property_t * xcontract_helper::buffered_property(const std::string& key, const std::string& addr, bool is_map) {
+    if (!is_self(addr)) {
+        return nullptr;
+    }
+    sync_decoded(key);
+    auto iter = m_buffer.find(key);
+    if (iter == m_buffer.end() || iter->second.is_map != is_map) {
+        return nullptr;
+    }
+    return &iter->second;
+}
+
+const xcontract_helper::xbuffered_value_t * xcontract_helper::buffered_field(const std::string& key, const std::string& field, const std::string& addr) {
+    auto property = buffered_property(key, addr, true);
+    if (property == nullptr) {
+        return nullptr;
+    }
+    auto iter = property->field_values.find(field);
+    if (iter == property->field_values.end()) {
+        return nullptr;
+    }
+    return &iter->second;
+}
+
+void xcontract_helper::commit_property(const std::string& key, xbuffered_property_t const & property) {
+    if (!property.is_map) {
+        if (m_account_context->string_set(key, property.value.value, property.value.native)) {
+            throw xvm_error{enum_xvm_error_code::enum_vm_exception, "STRING_SET " + key + " error"};
+        }
+        return;
+    }
+    for (auto const & field : property.fields) {
+        auto const & field_value = property.field_values.at(field);
+        if (m_account_context->map_set(key, field, field_value.value, field_value.native)) {
+            throw xvm_error{enum_xvm_error_code::enum_vm_exception, "MAP_SET " + key + " error"};
+        }
+    }
+}
+
+void xcontract_helper::flush_key(const std::string& key) {
+    sync_decoded(key);
+    auto iter = m_buffer.find(key);
+    if (iter == m_buffer.end()) {
+        return;
+    }
+    auto property = std::move(iter->second);
+    m_buffer.erase(iter);
+    m_buffer_order.erase(std::find(m_buffer_order.begin(), m_buffer_order.end(), key));
+    commit_property(key, property);
+}
+
+void xcontract_helper::flush() {
+    // only decoded values of our own can be dirty
+    for (auto const & decoded : m_decoded) {
+        sync_decoded(decoded.first);
+    }
+    XMETRICS_COUNTER_INCREMENT("xvm_property_buffer_flush_key", m_buffer_order.size());
+    // keep the buffer until all are committed, a failed commit fails the transaction anyway
+    for (auto const & key : m_buffer_order) {
+        commit_property(key, m_buffer.at(key));
+    }
+    discard();
+}
+
+void xcontract_helper::discard() noexcept {
+    m_buffer.clear();
+    m_buffer_order.clear();
+    m_checked_writes.clear();
+    m_decoded.clear();
+}
+
+std::string xcontract_helper::decoded_key(const std::string& key, const std::string& addr) const {
+    return is_self(addr) ? key : addr + "/" + key;
+}
+
+xdecoded_property_face_t* xcontract_helper::decoded_property(const std::string& key, const std::string& field, const std::string& addr) {
+    auto iter = m_decoded.find(decoded_key(key, addr));
+    if (iter == m_decoded.end()) {
+        return nullptr;
+    }
+    auto field_iter = iter->second.find(field);
+    return field_iter == iter->second.end() ? nullptr : field_iter->second.get();
+}
+
+xdecoded_property_face_t* xcontract_helper::put_decoded_property(const std::string& key, const std::string& field, const std::string& addr, std::unique_ptr<xdecoded_property_face_t> decoded) {
+    auto & slot = m_decoded[decoded_key(key, addr)][field];
+    slot = std::move(decoded);
+    return slot.get();
+}
+
+void xcontract_helper::sync_decoded(const std::string& key) {
+    auto iter = m_decoded.find(key);
+    if (iter == m_decoded.end()) {
+        return;
+    }
+    for (auto & decoded : iter->second) {
+        auto & value = *decoded.second;
+        if (!value.dirty) {
+            continue;
+        }
+        value.dirty = false;
+        XMETRICS_COUNTER_INCREMENT("xvm_decoded_property_encode", 1);
+        if (decoded.first.empty()) {
+            auto & property = buffer_property(key, false);
+            property.value.value = value.encode();
+            property.value.native = false;
+        } else {
+            auto & property = buffer_property(key, true);
+            auto field_iter = property.field_values.find(decoded.first);
+            if (field_iter == property.field_values.end()) {
+                property.fields.push_back(decoded.first);
+                field_iter = property.field_values.emplace(decoded.first, xbuffered_value_t{}).first;
+            }
+            field_iter->second.value = value.encode();
+            field_iter->second.native = false;
+        }
+    }
+}
+
+void xcontract_helper::drop_decoded(const std::string& key, const std::string* field) {
+    if (m_decoded.empty()) {
+        return;
+    }
+    auto iter = m_decoded.find(key);
+    if (iter == m_decoded.end()) {
+        return;
+    }
+    if (field == nullptr) {
+        m_decoded.erase(iter);
+    } else {
+        iter->second.erase(*field);
+    }
+}
+
+xforeign_version_t xcontract_helper::foreign_version(const std::string& addr) const {
+    xforeign_version_t version;
+    version.height = m_account_context->get_blockchain_height(addr);
+    auto block = get_block_by_height(addr, version.height);
+    if (block != nullptr) {
+        version.block_hash = block->get_block_hash();
+    }
+    return version;
+}
+
+xforeign_string_ptr_t xcontract_helper::foreign_string_get(const std::string& key, const std::string& addr) {
+    auto version = foreign_version(addr);
+    auto & cache = xvm_foreign_read_cache::instance();
+    auto cached = cache.get_string(addr, key, version);
+    if (cached != nullptr) {
+        return cached;
+    }
+    auto value = std::make_shared<std::string>();
+    if (m_account_context->string_get(key, *value, addr)) {
+        return nullptr;
+    }
+    cache.put_string(addr, key, version, value);
+    return value;
+}
+
+xforeign_string_ptr_t xcontract_helper::foreign_field_get(const std::string& key, const std::string& field, const std::string& addr) {
+    auto version = foreign_version(addr);
+    auto & cache = xvm_foreign_read_cache::instance();
+    auto cached = cache.get_field(addr, key, field, version);
+    if (cached != nullptr) {
+        return cached;
+    }
+    auto value = std::make_shared<std::string>();
+    if (m_account_context->map_get(key, field, *value, addr)) {
+        return nullptr;
+    }
+    cache.put_field(addr, key, field, version, value);
+    return value;
+}
+
+xforeign_map_ptr_t xcontract_helper::foreign_map_copy_get(const std::string& key, const std::string& addr) {
+    auto version = foreign_version(addr);
+    auto & cache = xvm_foreign_read_cache::instance();
+    auto cached = cache.get_map(addr, key, version);
+    if (cached != nullptr) {
+        return cached;
+    }
+    auto value = std::make_shared<std::map<std::string, std::string>>();
+    if (m_account_context->map_copy_get(key, *value, addr)) {
+        return nullptr;
+    }
+    cache.put_map(addr, key, version, value);
+    return value;
+}
+
 int32_t xcontract_helper::get_gas_and_disk_usage(std::uint32_t &gas, std::uint32_t &disk) const {
     store::xtransaction_result_t result;
     m_account_context->get_transaction_result(result);
@@ -4,10 +4,16 @@
 
 #pragma once
 
+#include <functional>
+#include <memory>
+#include <typeinfo>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "xcommon/xlogic_time.h"
+#include "xvm/xvm_foreign_read_cache.h"
+#include "xvm/xvm_profiler.h"
 #include "xstore/xaccount_context.h"
 
 NS_BEG2(top, xvm)
@@ -18,6 +24,23 @@ NS_BEG2(top, xvm)
         }                                                                                    \
     } while (false)
 
+/**
+ * @brief a property value decoded for one execution, see xproperty_handle
+ *
+ */
+class xdecoded_property_face_t {
+public:
+    virtual ~xdecoded_property_face_t() = default;
+    virtual std::type_info const & type() const noexcept = 0;
+    virtual std::string encode() = 0;
+
+    bool    exist{false};   // the property value is not empty when decoded
+    bool    dirty{false};   // changed since decoded or last written back
+};
+
+// map property visitor, the field and the value, returns false to stop visiting
+using xmap_visitor_t = std::function<bool(const std::string&, const std::string&)>;
+
 class xcontract_helper {
 public:
     xcontract_helper(store::xaccount_context_t* account_context, common::xnode_id_t const & contract_account, const std::string& exec_account);
@@ -61,6 +84,17 @@ public:
     bool map_key_exist(const std::string& key);
     void map_clear(const std::string& key, bool native = false);
     void get_map_property(const std::string& key, std::map<std::string, std::string>& value, uint64_t height, const std::string& addr="");
+    /**
+     * @brief visit the fields of the map property in [first, last) in order. a map of another
+     *        account is not copied, a map of this account is copied once as map_copy_get does
+     *
+     * @param key  the map property key
+     * @param first  the first field to visit, empty for the beginning
+     * @param last  the field to stop before, empty for the end
+     * @param visitor  called for each field, returns false to stop
+     * @param addr  the addr the map property belong to
+     */
+    void map_for_each(const std::string& key, const std::string& first, const std::string& last, xmap_visitor_t const & visitor, const std::string& addr = "");
     bool map_property_exist(const std::string& key);
 
     void generate_tx(common::xaccount_address_t const & target_addr, const std::string& func_name, const std::string& func_param);
@@ -81,11 +115,93 @@ public:
     int32_t
     get_gas_and_disk_usage(std::uint32_t &gas, std::uint32_t &disk) const;
 
+    /**
+     * @brief record the host calls to the profile, NULL to stop profiling
+     *
+     * @param profile  the host call profile
+     */
+    void set_profile(xhost_call_profile_t* profile) noexcept { m_profile = profile; }
+    xhost_call_profile_t* profile() const noexcept { return m_profile; }
+
+    /**
+     * @brief commit the buffered string and map writes to the account context,
+     *        called once the transaction succeeds
+     *
+     */
+    void flush();
+
+    /**
+     * @brief drop the buffered writes
+     *
+     */
+    void discard() noexcept;
+
+    /**
+     * @brief whether the addr of a property is the contract itself
+     *
+     * @param addr  the addr passed to the property methods, empty for the contract
+     */
+    bool is_self(const std::string& addr) const;
+
+    /**
+     * @brief get the decoded value of a string property or a map field cached for this execution
+     *
+     * @param key  the property key
+     * @param field  the map field, empty for a string property
+     * @param addr  the addr the property belong to
+     * @return xdecoded_property_face_t*  nullptr if not decoded yet
+     */
+    xdecoded_property_face_t* decoded_property(const std::string& key, const std::string& field, const std::string& addr);
+    xdecoded_property_face_t* put_decoded_property(const std::string& key, const std::string& field, const std::string& addr, std::unique_ptr<xdecoded_property_face_t> decoded);
+
+private:
+    struct xbuffered_value_t {
+        std::string     value;
+        bool            native{false};
+    };
+
+    // a buffered string property, or the buffered fields of a map property
+    struct xbuffered_property_t {
+        bool                                                    is_map{false};
+        xbuffered_value_t                                       value;
+        std::vector<std::string>                                fields;     // in the order of the first write
+        std::unordered_map<std::string, xbuffered_value_t>      field_values;
+    };
+
+    // whether a write of the key with the native flag already went to the store in this execution.
+    // the first one does, so the errors of a set are thrown where the contract can still catch them,
+    // the later ones are buffered
+    bool write_checked(const std::string& key, bool native) const;
+    xbuffered_property_t & buffer_property(const std::string& key, bool is_map);
+    const xbuffered_property_t * buffered_property(const std::string& key, const std::string& addr, bool is_map);
+    const xbuffered_value_t * buffered_field(const std::string& key, const std::string& field, const std::string& addr = "");
+    void commit_property(const std::string& key, xbuffered_property_t const & property);
+    // commit the buffered writes of the key, before it is accessed as a whole
+    void flush_key(const std::string& key);
+    std::string decoded_key(const std::string& key, const std::string& addr) const;
+    // encode the changed decoded values of the key into the write buffer
+    void sync_decoded(const std::string& key);
+    // a raw write of the key, or of a field when given, wins over the decoded values
+    void drop_decoded(const std::string& key, const std::string* field = nullptr);
+    // the block of another account its properties are read at
+    xforeign_version_t foreign_version(const std::string& addr) const;
+    // read the property of another account through the foreign read cache, nullptr on a store error
+    xforeign_string_ptr_t foreign_string_get(const std::string& key, const std::string& addr);
+    xforeign_string_ptr_t foreign_field_get(const std::string& key, const std::string& field, const std::string& addr);
+    xforeign_map_ptr_t foreign_map_copy_get(const std::string& key, const std::string& addr);
+
 private:
     store::xaccount_context_t*      m_account_context;
     common::xnode_id_t const &      m_contract_account;
     const std::string&              m_exec_account;
     data::xtransaction_ptr_t              m_transaction{};
+    xhost_call_profile_t*           m_profile{nullptr};
+    // transaction local write buffer, string_set and map_set after the first one of a key go here until flush
+    std::vector<std::string>                                m_buffer_order;
+    std::unordered_map<std::string, xbuffered_property_t>   m_buffer;
+    std::unordered_map<std::string, bool>                   m_checked_writes;   // key -> native flag of its first write
+    // property key ("addr/key" for another account) -> map field ("" for string) -> decoded value
+    std::unordered_map<std::string, std::unordered_map<std::string, std::unique_ptr<xdecoded_property_face_t>>> m_decoded;
 };
 
 NS_END2
@@ -143,6 +143,23 @@ struct xcontract_info_t {
         return nullptr;
     }
 
+    /**
+     * @brief find the monitor matching a block owner, either registered for the owner itself
+     *        or, for a table address, for its base address (see xcontract_address_map_t::match)
+     *
+     * @param address the block owner
+     * @param base_address the owner without its table id suffix, may be empty
+     * @return xblock_monitor_info_t*
+     */
+    inline
+    xblock_monitor_info_t* find(common::xaccount_address_t const & address, common::xaccount_address_t const & base_address) {
+        auto info = find(address);
+        if (info == nullptr && base_address.has_value()) {
+            info = find(base_address);
+        }
+        return info;
+    }
+
     inline
     bool has_monitors() {
         return has_block_monitors() || has_broadcasts();
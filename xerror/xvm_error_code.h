@@ -48,6 +48,11 @@ enum class enum_xvm_error_code
     vm_vote_update_db_error,
     vm_vote_proposal_property_error,
 
+    enum_lua_memory_limit_exceeded,
+    enum_lua_exec_tgas_limit_exceeded,
+
+    enum_vm_code_parse_error,
+
     error_max,
 };
 
@@ -88,6 +93,11 @@ inline std::string xvm_error_to_string(int32_t code) {
         XVM_TO_STR(vm_vote_voter_voted_or_proxy),
         XVM_TO_STR(vm_vote_update_db_error),
         XVM_TO_STR(vm_vote_proposal_property_error),
+
+        XVM_TO_STR(enum_lua_memory_limit_exceeded),
+        XVM_TO_STR(enum_lua_exec_tgas_limit_exceeded),
+
+        XVM_TO_STR(enum_vm_code_parse_error),
     };
     return names[code - (int32_t)enum_xvm_error_code::error_base - 1];
 }
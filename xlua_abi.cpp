@@ -0,0 +1,257 @@
+// Copyright (c) 2017-2018 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+#include "xvm/xlua_abi.h"
+#include "xvm/xlua_engine.h"
+
+#include <cstring>
+
+NS_BEG2(top, xvm)
+using base::xstream_t;
+
+static const char* g_arg_type_names[] = {
+    "int64",    // ARG_TYPE_INT64
+    "uint64",   // ARG_TYPE_UINT64
+    "string",   // ARG_TYPE_STRING
+    "bool",     // ARG_TYPE_BOOL
+    "bytes",    // ARG_TYPE_BYTES
+    "array",    // ARG_TYPE_ARRAY
+    "map",      // ARG_TYPE_MAP
+};
+
+const char* xlua_abi::type_name(uint8_t arg_type) {
+    if (arg_type >= sizeof(g_arg_type_names) / sizeof(g_arg_type_names[0])) {
+        return "unknown";
+    }
+    return g_arg_type_names[arg_type];
+}
+
+static std::vector<std::string> split(const std::string& text, char delimiter) {
+    std::vector<std::string> items;
+    std::string::size_type begin{0};
+    while (begin <= text.size()) {
+        auto end = text.find(delimiter, begin);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        items.push_back(text.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    return items;
+}
+
+xlua_abi::xlua_abi(const std::string& descriptor)
+:m_descriptor(descriptor) {
+    if (descriptor.empty()) {
+        return;
+    }
+    for (auto const & action : split(descriptor, ';')) {
+        if (action.empty()) {
+            continue;
+        }
+        auto pos = action.find(':');
+        auto action_name = action.substr(0, pos);
+        if (action_name.empty() || m_actions.find(action_name) != m_actions.end()) {
+            throw xvm_error{enum_xvm_error_code::enum_lua_abi_input_name_or_type_error, "abi action name error:" + action};
+        }
+        std::vector<uint8_t> arg_types;
+        if (pos != std::string::npos && pos + 1 < action.size()) {
+            for (auto const & type : split(action.substr(pos + 1), ',')) {
+                uint8_t arg_type{0};
+                while (arg_type < sizeof(g_arg_type_names) / sizeof(g_arg_type_names[0]) && type != g_arg_type_names[arg_type]) {
+                    arg_type++;
+                }
+                if (arg_type == sizeof(g_arg_type_names) / sizeof(g_arg_type_names[0])) {
+                    throw xvm_error{enum_xvm_error_code::enum_lua_abi_input_name_or_type_error, "abi arg type error:" + type};
+                }
+                arg_types.push_back(arg_type);
+            }
+        }
+        if (arg_types.size() > MAX_ARG_NUM) {
+            throw xvm_error{enum_xvm_error_code::enum_lua_abi_input_name_or_type_error, "abi arg num of " + action_name + " great than max number 16"};
+        }
+        m_actions[action_name] = std::move(arg_types);
+    }
+}
+
+const std::vector<uint8_t>* xlua_abi::find(const std::string& action_name) const {
+    auto iter = m_actions.find(action_name);
+    if (iter == m_actions.end()) {
+        return NULL;
+    }
+    return &iter->second;
+}
+
+xlua_abi_decoder::xlua_abi_decoder(xstream_t& stream, const std::vector<uint8_t>* arg_types)
+:m_stream(stream), m_arg_types(arg_types) {
+}
+
+int32_t xlua_abi_decoder::push_args(lua_State* L, int32_t& argn) {
+    int top = lua_gettop(L);
+    lua_pushlightuserdata(L, this);
+    lua_pushcclosure(L, decode_args, 1);
+    int32_t status = lua_pcall(L, 0, LUA_MULTRET, 0);
+    if (m_failed) {
+        lua_settop(L, top);
+        throw m_error;
+    }
+    argn = status == LUA_OK ? lua_gettop(L) - top : 0;
+    return status;
+}
+
+int xlua_abi_decoder::decode_args(lua_State* L) {
+    auto decoder = reinterpret_cast<xlua_abi_decoder*>(lua_touserdata(L, lua_upvalueindex(1)));
+    try {
+        return decoder->decode(L);
+    } catch(const xvm_error& e) {
+        decoder->m_error = e;
+    } catch(enum_xerror_code& e) {
+        decoder->m_error = xvm_error{enum_xvm_error_code::enum_lua_abi_input_error, "action_param stream is not valid"};
+    } catch(const std::exception& e) {
+        xkinfo_lua("%s", e.what());
+        decoder->m_error = xvm_error{enum_xvm_error_code::enum_lua_abi_input_error, "param not valid"};
+    } catch(...) {
+        decoder->m_error = xvm_error{enum_xvm_error_code::enum_lua_abi_input_error, "unkown exception"};
+    }
+    // raise the lua error out of the catch block
+    decoder->m_failed = true;
+    return luaL_error(L, "%s", decoder->m_error.what());
+}
+
+int32_t xlua_abi_decoder::decode(lua_State* L) {
+    if (m_stream.size() == 0) {
+        if (m_arg_types != NULL && !m_arg_types->empty()) {
+            throw xvm_error{enum_xvm_error_code::enum_lua_abi_input_error, "arg num 0 not match abi arg num " + std::to_string(m_arg_types->size())};
+        }
+        return 0;
+    }
+
+    uint8_t arg_num{0}, arg_type{0};
+    m_stream >> arg_num;
+    if (arg_num > MAX_ARG_NUM) {
+        throw xvm_error{enum_xvm_error_code::enum_lua_abi_input_error, "arg num " + std::to_string(arg_num) + " great than max number 16"};
+    }
+    if (m_arg_types != NULL && m_arg_types->size() != arg_num) {
+        throw xvm_error{enum_xvm_error_code::enum_lua_abi_input_error, "arg num " + std::to_string(arg_num) + " not match abi arg num " + std::to_string(m_arg_types->size())};
+    }
+    luaL_checkstack(L, arg_num, "too many args");
+    for (uint8_t i = 0; i < arg_num; i++) {
+        m_stream >> arg_type;
+        if (m_arg_types != NULL && (*m_arg_types)[i] != arg_type) {
+            throw xvm_error{enum_xvm_error_code::enum_lua_abi_input_type_error, "arg " + std::to_string(i + 1) + " type " + xlua_abi::type_name(arg_type) + " not match abi type " + xlua_abi::type_name((*m_arg_types)[i])};
+        }
+        // args of the contracts without abi keep the old types: uint64, string and bool
+        if (m_arg_types == NULL && (arg_type == ARG_TYPE_INT64 || arg_type > ARG_TYPE_BOOL)) {
+            throw xvm_error{enum_xvm_error_code::enum_lua_abi_input_error, "param stream not valid"};
+        }
+        decode_value(L, arg_type, 0);
+    }
+    return arg_num;
+}
+
+uint32_t xlua_abi_decoder::decode_count() {
+    uint32_t count{0};
+    m_stream >> count;
+    // each element takes at least one byte, don't trust a count the stream can't hold
+    if (count > static_cast<uint32_t>(m_stream.size())) {
+        throw xvm_error{enum_xvm_error_code::enum_lua_abi_input_error, "element count " + std::to_string(count) + " great than stream size"};
+    }
+    return count;
+}
+
+void xlua_abi_decoder::push_bytes(lua_State* L, uint32_t max_size) {
+    uint32_t size{0};
+    m_stream >> size;
+    if (size > max_size) {
+        throw xvm_error{enum_xvm_error_code::enum_lua_abi_input_error, "arg bytes size " + std::to_string(size) + " great than " + std::to_string(max_size)};
+    }
+    if (size > static_cast<uint32_t>(m_stream.size())) {
+        throw xvm_error{enum_xvm_error_code::enum_lua_abi_input_error, "arg bytes size " + std::to_string(size) + " great than stream size"};
+    }
+    lua_pushlstring(L, reinterpret_cast<const char*>(m_stream.data()), size);
+    m_stream.pop_front(size);
+}
+
+void xlua_abi_decoder::push_string(lua_State* L) {
+    // the xstream string encoding of the old clients: uint32 size + bytes
+    uint32_t size{0};
+    m_stream >> size;
+    if (size > static_cast<uint32_t>(m_stream.size())) {
+        throw xvm_error{enum_xvm_error_code::enum_lua_abi_input_error, "action_param stream is not valid"};
+    }
+    if (size > MAX_ARG_STRING_SIZE) {
+        throw xvm_error{enum_xvm_error_code::enum_lua_abi_input_error, "arg string size " + std::to_string(size) + " length greater than 128"};
+    }
+    auto data = reinterpret_cast<const char*>(m_stream.data());
+    // contracts without abi got the string up to the first '\0', as lua_pushstring did
+    lua_pushlstring(L, data, m_arg_types == NULL ? strnlen(data, size) : size);
+    m_stream.pop_front(size);
+}
+
+void xlua_abi_decoder::decode_value(lua_State* L, uint8_t arg_type, uint32_t depth) {
+    switch (arg_type) {
+        case ARG_TYPE_INT64: {
+            int64_t value{0};
+            m_stream >> value;
+            lua_pushinteger(L, static_cast<lua_Integer>(value));
+            break;
+        }
+        case ARG_TYPE_UINT64: {
+            uint64_t value{0};
+            m_stream >> value;
+            lua_pushnumber(L, value);
+            break;
+        }
+        case ARG_TYPE_STRING:
+            push_string(L);
+            break;
+        case ARG_TYPE_BOOL: {
+            bool value{false};
+            m_stream >> value;
+            lua_pushboolean(L, value);
+            break;
+        }
+        case ARG_TYPE_BYTES:
+            push_bytes(L, MAX_ARG_BYTES_SIZE);
+            break;
+        case ARG_TYPE_ARRAY: {
+            if (depth >= MAX_ARG_DEPTH) {
+                throw xvm_error{enum_xvm_error_code::enum_lua_abi_input_error, "arg depth great than " + std::to_string(MAX_ARG_DEPTH)};
+            }
+            auto count = decode_count();
+            luaL_checkstack(L, 2, "arg too deep");
+            lua_createtable(L, count, 0);
+            for (uint32_t i = 1; i <= count; i++) {
+                uint8_t elem_type{0};
+                m_stream >> elem_type;
+                decode_value(L, elem_type, depth + 1);
+                lua_rawseti(L, -2, i);
+            }
+            break;
+        }
+        case ARG_TYPE_MAP: {
+            if (depth >= MAX_ARG_DEPTH) {
+                throw xvm_error{enum_xvm_error_code::enum_lua_abi_input_error, "arg depth great than " + std::to_string(MAX_ARG_DEPTH)};
+            }
+            auto count = decode_count();
+            luaL_checkstack(L, 3, "arg too deep");
+            lua_createtable(L, 0, count);
+            for (uint32_t i = 0; i < count; i++) {
+                uint8_t key_type{0}, value_type{0};
+                m_stream >> key_type;
+                if (key_type == ARG_TYPE_ARRAY || key_type == ARG_TYPE_MAP) {
+                    throw xvm_error{enum_xvm_error_code::enum_lua_abi_input_type_error, "map key type " + std::string(xlua_abi::type_name(key_type)) + " not support"};
+                }
+                decode_value(L, key_type, depth + 1);
+                m_stream >> value_type;
+                decode_value(L, value_type, depth + 1);
+                lua_rawset(L, -3);
+            }
+            break;
+        }
+        default:
+            throw xvm_error{enum_xvm_error_code::enum_lua_abi_input_error, "param stream not valid"};
+    }
+}
+
+NS_END2
@@ -0,0 +1,96 @@
+// Copyright (c) 2017-2018 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+#include <string>
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include "xvm_define.h"
+#include "xerror/xvm_error.h"
+#include "xbase/xmem.h"
+extern "C"
+{
+	#include <lua.h>
+	#include <lualib.h>
+	#include <lauxlib.h>
+}
+NS_BEG2(top, xvm)
+#define XPROPERTY_CONTRACT_ABI_KEY  "$ContractAbi"
+#define MAX_ARG_DEPTH               8       // nesting levels of array and map args
+#define MAX_ARG_BYTES_SIZE          (64 * 1024)
+
+/**
+ * @brief the abi descriptor of a lua contract, which declares the arg types of the actions.
+ *        descriptor text: "action1:type,type;action2:type", type is one of
+ *        int64 uint64 string bool bytes array map
+ *
+ */
+class xlua_abi {
+public:
+    xlua_abi() = default;
+
+    /**
+     * @brief parse the descriptor text, throw enum_lua_abi_input_error if not valid
+     *
+     * @param descriptor  the descriptor text, empty means no abi
+     */
+    explicit xlua_abi(const std::string& descriptor);
+
+    bool empty() const noexcept { return m_actions.empty(); }
+    const std::string& descriptor() const noexcept { return m_descriptor; }
+
+    /**
+     * @brief find the arg types of the action
+     *
+     * @param action_name  the action name
+     * @return const std::vector<uint8_t>*  the arg types, NULL if the action is not declared
+     */
+    const std::vector<uint8_t>* find(const std::string& action_name) const;
+
+    static const char* type_name(uint8_t arg_type);
+
+private:
+    std::string                                             m_descriptor;
+    std::unordered_map<std::string, std::vector<uint8_t>>   m_actions;
+};
+
+/**
+ * @brief decode the typed action param to lua values. strings and bytes are pushed
+ *        from the stream buffer directly, no temporary string is made
+ *
+ */
+class xlua_abi_decoder {
+public:
+    /**
+     * @param stream  the action param stream
+     * @param arg_types  the declared arg types, NULL if the contract has no abi
+     */
+    xlua_abi_decoder(base::xstream_t& stream, const std::vector<uint8_t>* arg_types);
+
+    /**
+     * @brief push the args to the lua stack in a protected call, so a memory error
+     *        while pushing doesn't escape the lua state
+     *
+     * @param L  the lua state
+     * @param argn  the number of args pushed
+     * @return int32_t  the lua status, LUA_ERRMEM if the memory limit is hit
+     */
+    int32_t push_args(lua_State* L, int32_t& argn);
+
+private:
+    static int decode_args(lua_State* L);
+    int32_t decode(lua_State* L);
+    void decode_value(lua_State* L, uint8_t arg_type, uint32_t depth);
+    void push_bytes(lua_State* L, uint32_t max_size);
+    void push_string(lua_State* L);
+    uint32_t decode_count();
+
+private:
+    base::xstream_t&                m_stream;
+    const std::vector<uint8_t>*     m_arg_types;
+    bool                            m_failed{false};
+    xvm_error                       m_error{enum_xvm_error_code::enum_lua_abi_input_error, "param stream not valid"};
+};
+NS_END2
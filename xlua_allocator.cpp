@@ -0,0 +1,127 @@
+// Copyright (c) 2017-2018 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+#include "xvm/xlua_allocator.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+NS_BEG2(top, xvm)
+
+xlua_allocator::xlua_allocator(std::size_t memory_limit)
+:m_memory_limit(memory_limit) {
+}
+
+xlua_allocator::~xlua_allocator() {
+    for (auto chunk : m_chunks) {
+        std::free(chunk);
+    }
+    m_chunks.clear();
+}
+
+void* xlua_allocator::alloc(void* ud, void* ptr, size_t osize, size_t nsize) {
+    return reinterpret_cast<xlua_allocator*>(ud)->reallocate(ptr, osize, nsize);
+}
+
+void xlua_allocator::reset_peak() noexcept {
+    m_memory_peak = m_memory_usage;
+    m_memory_base = m_memory_usage;
+    m_alloc_count = 0;
+    m_limit_exceeded = false;
+}
+
+std::size_t xlua_allocator::size_class(size_t size) noexcept {
+    return (size + LUA_ALLOC_SIZE_CLASS_STEP - 1) / LUA_ALLOC_SIZE_CLASS_STEP - 1;
+}
+
+void* xlua_allocator::reallocate(void* ptr, size_t osize, size_t nsize) {
+    // when ptr is NULL, osize is the type of the new object
+    if (ptr == nullptr) {
+        osize = 0;
+    }
+
+    if (nsize == 0) {
+        deallocate(ptr, osize);
+        m_memory_usage -= osize;
+        return nullptr;
+    }
+
+    // shrinking must never fail
+    if (nsize > osize && m_memory_usage + (nsize - osize) > m_memory_base + m_memory_limit) {
+        m_limit_exceeded = true;
+        return nullptr;
+    }
+
+    void* block{nullptr};
+    if (ptr != nullptr && osize > 0 && size_class(osize) == size_class(nsize) && nsize <= LUA_ALLOC_SIZE_CLASS_STEP * LUA_ALLOC_SIZE_CLASS_NUM) {
+        block = ptr;
+    } else if (ptr != nullptr && osize > LUA_ALLOC_SIZE_CLASS_STEP * LUA_ALLOC_SIZE_CLASS_NUM && nsize > LUA_ALLOC_SIZE_CLASS_STEP * LUA_ALLOC_SIZE_CLASS_NUM) {
+        block = std::realloc(ptr, nsize);
+        if (block == nullptr) {
+            return nullptr;
+        }
+    } else {
+        block = allocate(nsize);
+        if (block == nullptr) {
+            return nullptr;
+        }
+        if (ptr != nullptr) {
+            std::memcpy(block, ptr, std::min(osize, nsize));
+            deallocate(ptr, osize);
+        }
+    }
+
+    if (block != ptr) {
+        m_alloc_count++;
+    }
+    m_memory_usage = m_memory_usage - osize + nsize;
+    m_memory_peak = std::max(m_memory_peak, m_memory_usage);
+    return block;
+}
+
+void* xlua_allocator::allocate(size_t size) {
+    if (size > LUA_ALLOC_SIZE_CLASS_STEP * LUA_ALLOC_SIZE_CLASS_NUM) {
+        return std::malloc(size);
+    }
+
+    auto idx = size_class(size);
+    if (m_free_list[idx] != nullptr) {
+        auto block = m_free_list[idx];
+        m_free_list[idx] = block->next;
+        return block;
+    }
+
+    auto block_size = (idx + 1) * LUA_ALLOC_SIZE_CLASS_STEP;
+    if (m_chunk_left < block_size) {
+        // the tail of the old chunk is dropped, at most one small block is wasted
+        auto chunk = reinterpret_cast<char*>(std::malloc(LUA_ALLOC_CHUNK_SIZE));
+        if (chunk == nullptr) {
+            return nullptr;
+        }
+        m_chunks.push_back(chunk);
+        m_chunk_cur = chunk;
+        m_chunk_left = LUA_ALLOC_CHUNK_SIZE;
+    }
+    auto block = m_chunk_cur;
+    m_chunk_cur += block_size;
+    m_chunk_left -= block_size;
+    return block;
+}
+
+void xlua_allocator::deallocate(void* ptr, size_t size) {
+    if (ptr == nullptr) {
+        return;
+    }
+    if (size > LUA_ALLOC_SIZE_CLASS_STEP * LUA_ALLOC_SIZE_CLASS_NUM) {
+        std::free(ptr);
+        return;
+    }
+
+    auto idx = size_class(size);
+    auto block = reinterpret_cast<xfree_block_t*>(ptr);
+    block->next = m_free_list[idx];
+    m_free_list[idx] = block;
+}
+
+NS_END2
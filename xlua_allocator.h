@@ -0,0 +1,79 @@
+// Copyright (c) 2017-2018 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "xbasic/xns_macro.h"
+NS_BEG2(top, xvm)
+#define LUA_MEMORY_LIMIT_DEFAULT        (16 * 1024 * 1024)
+#define LUA_ALLOC_SIZE_CLASS_STEP       16
+#define LUA_ALLOC_SIZE_CLASS_NUM        16      // small blocks up to 256 bytes
+#define LUA_ALLOC_CHUNK_SIZE            (64 * 1024)
+
+/**
+ * @brief lua allocator of one lua state. small blocks are carved from chunks and
+ *        recycled by size class, large blocks go to malloc. allocation fails once
+ *        the bytes allocated since the last reset_peak would exceed the memory limit,
+ *        what the reused state held before is not counted
+ *
+ */
+class xlua_allocator {
+public:
+    explicit xlua_allocator(std::size_t memory_limit = LUA_MEMORY_LIMIT_DEFAULT);
+    ~xlua_allocator();
+    xlua_allocator(const xlua_allocator&) = delete;
+    xlua_allocator& operator=(const xlua_allocator&) = delete;
+
+    /**
+     * @brief the lua_Alloc function, ud is the allocator
+     *
+     */
+    static void* alloc(void* ud, void* ptr, size_t osize, size_t nsize);
+
+    void set_memory_limit(std::size_t memory_limit) noexcept { m_memory_limit = memory_limit; }
+    std::size_t memory_limit() const noexcept { return m_memory_limit; }
+    std::size_t memory_usage() const noexcept { return m_memory_usage; }
+    std::size_t memory_peak() const noexcept { return m_memory_peak; }
+    std::size_t memory_base() const noexcept { return m_memory_base; }
+    uint64_t alloc_count() const noexcept { return m_alloc_count; }
+
+    /**
+     * @brief start a new measure of the peak, the alloc count and the memory limit, called at
+     *        the begin of each transaction right after a full gc, so that the limit only sees
+     *        what the transaction allocates
+     *
+     */
+    void reset_peak() noexcept;
+
+    /**
+     * @brief whether an allocation is refused since the last reset_peak
+     *
+     */
+    bool limit_exceeded() const noexcept { return m_limit_exceeded; }
+
+private:
+    void* reallocate(void* ptr, size_t osize, size_t nsize);
+    void* allocate(size_t size);
+    void  deallocate(void* ptr, size_t size);
+    static std::size_t size_class(size_t size) noexcept;
+
+private:
+    struct xfree_block_t {
+        xfree_block_t* next;
+    };
+
+    xfree_block_t*          m_free_list[LUA_ALLOC_SIZE_CLASS_NUM]{};
+    std::vector<char*>      m_chunks;
+    char*                   m_chunk_cur{nullptr};
+    std::size_t             m_chunk_left{0};
+    std::size_t             m_memory_limit;
+    std::size_t             m_memory_usage{0};
+    std::size_t             m_memory_peak{0};
+    std::size_t             m_memory_base{0};   // the bytes in use at the last reset_peak
+    uint64_t                m_alloc_count{0};
+    bool                    m_limit_exceeded{false};
+};
+NS_END2
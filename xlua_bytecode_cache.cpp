@@ -0,0 +1,140 @@
+// Copyright (c) 2017-2018 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+#include "xvm/xlua_bytecode_cache.h"
+#include "xvm/xvm_define.h"
+#include "xutility/xhash.h"
+#include "xmetrics/xmetrics.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+NS_BEG2(top, xvm)
+
+xlua_bytecode_cache& xlua_bytecode_cache::instance() {
+    static xlua_bytecode_cache * inst = new xlua_bytecode_cache();
+    return *inst;
+}
+
+xlua_bytecode_cache::xlua_bytecode_cache()
+:m_cache(LUA_BYTECODE_CACHE_CAPACITY) {
+}
+
+std::string xlua_bytecode_cache::code_hash(const std::string& code) {
+    static const char hex_chars[] = "0123456789abcdef";
+    uint256_t hash = utl::xsha2_256_t::digest(code.data(), code.size());
+    std::string hex;
+    hex.reserve(hash.size() * 2);
+    for (size_t i = 0; i < hash.size(); i++) {
+        uint8_t c = static_cast<uint8_t>(hash.data()[i]);
+        hex.push_back(hex_chars[c >> 4]);
+        hex.push_back(hex_chars[c & 0x0f]);
+    }
+    return hex;
+}
+
+bool xlua_bytecode_cache::get(const std::string& hash, std::string& bytecode) {
+    bool hit{false};
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        hit = m_cache.get(hash, bytecode);
+    }
+    if (!hit && spill_read(hash, bytecode)) {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_cache.put(hash, bytecode);
+        hit = true;
+    }
+
+    if (hit) {
+        m_hit_count++;
+        XMETRICS_COUNTER_INCREMENT("xvm_lua_bytecode_cache_hit", 1);
+    } else {
+        m_miss_count++;
+        XMETRICS_COUNTER_INCREMENT("xvm_lua_bytecode_cache_miss", 1);
+    }
+    return hit;
+}
+
+void xlua_bytecode_cache::put(const std::string& hash, const std::string& bytecode) {
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_cache.put(hash, bytecode);
+    }
+    spill_write(hash, bytecode);
+}
+
+void xlua_bytecode_cache::set_spill_dir(const std::string& dir) {
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_spill_dir = dir;
+}
+
+std::string xlua_bytecode_cache::spill_dir() {
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_spill_dir;
+}
+
+std::string xlua_bytecode_cache::spill_file(const std::string& dir, const std::string& hash) {
+    return dir + "/" + hash + ".luac";
+}
+
+bool xlua_bytecode_cache::spill_read(const std::string& hash, std::string& bytecode) {
+    auto dir = spill_dir();
+    if (dir.empty()) {
+        return false;
+    }
+    auto file = spill_file(dir, hash);
+    std::ifstream in(file, std::ios::in | std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+    std::ostringstream buffer;
+    buffer << in.rdbuf();
+    auto content = buffer.str();
+    // the file is the sha256 of the chunk followed by the chunk, a chunk that doesn't match
+    // is never loaded, the code is compiled again and the file rewritten
+    uint256_t digest;
+    if (content.size() <= digest.size()) {
+        xwarn_lua("[xlua_bytecode_cache::spill_read] %s too short, size %zu", file.c_str(), content.size());
+        return false;
+    }
+    digest = utl::xsha2_256_t::digest(content.data() + digest.size(), content.size() - digest.size());
+    if (content.compare(0, digest.size(), reinterpret_cast<const char*>(digest.data()), digest.size()) != 0) {
+        xwarn_lua("[xlua_bytecode_cache::spill_read] %s digest mismatch", file.c_str());
+        XMETRICS_COUNTER_INCREMENT("xvm_lua_bytecode_cache_spill_corrupt", 1);
+        return false;
+    }
+    bytecode = content.substr(digest.size());
+    return true;
+}
+
+void xlua_bytecode_cache::spill_write(const std::string& hash, const std::string& bytecode) {
+    auto dir = spill_dir();
+    if (dir.empty()) {
+        return;
+    }
+    // write to a temp file first, so a reader never sees a partial chunk
+    auto file = spill_file(dir, hash);
+    auto tmp_file = file + ".tmp";
+    uint256_t digest = utl::xsha2_256_t::digest(bytecode.data(), bytecode.size());
+    {
+        std::ofstream out(tmp_file, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            xwarn_lua("[xlua_bytecode_cache::spill_write] open %s failed", tmp_file.c_str());
+            return;
+        }
+        out.write(reinterpret_cast<const char*>(digest.data()), digest.size());
+        out.write(bytecode.data(), bytecode.size());
+        if (!out.good()) {
+            xwarn_lua("[xlua_bytecode_cache::spill_write] write %s failed", tmp_file.c_str());
+            std::remove(tmp_file.c_str());
+            return;
+        }
+    }
+    if (std::rename(tmp_file.c_str(), file.c_str()) != 0) {
+        xwarn_lua("[xlua_bytecode_cache::spill_write] rename %s failed", tmp_file.c_str());
+        std::remove(tmp_file.c_str());
+    }
+}
+
+NS_END2
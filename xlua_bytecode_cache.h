@@ -0,0 +1,75 @@
+// Copyright (c) 2017-2018 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+#include <string>
+#include <cstdint>
+#include <mutex>
+#include <atomic>
+#include "xbasic/xns_macro.h"
+#include "xbasic/xlru_cache.h"
+NS_BEG2(top, xvm)
+#define LUA_BYTECODE_CACHE_CAPACITY     1024
+
+/**
+ * @brief precompiled lua chunk cache, keyed by the hash of the contract code
+ *
+ */
+class xlua_bytecode_cache {
+public:
+    static xlua_bytecode_cache& instance();
+
+    /**
+     * @brief calc the cache key of the contract code
+     *
+     * @param code  the lua source code
+     * @return std::string  the hex string of code hash
+     */
+    static std::string code_hash(const std::string& code);
+
+    /**
+     * @brief get the precompiled chunk, look up the spill dir if not in memory. a spilled
+     *        chunk is checked against the sha256 stored with it, a mismatch is a miss
+     *
+     * @param hash  the code hash
+     * @param bytecode  the chunk to store to
+     * @return true  hit
+     * @return false  miss
+     */
+    bool get(const std::string& hash, std::string& bytecode);
+
+    /**
+     * @brief put the precompiled chunk, also write to the spill dir if set
+     *
+     * @param hash  the code hash
+     * @param bytecode  the chunk dumped by lua_dump
+     */
+    void put(const std::string& hash, const std::string& bytecode);
+
+    /**
+     * @brief Set the spill dir, empty means memory only. should be called before
+     *        executing transactions, and the dir must be private to the node
+     *
+     * @param dir  the dir to store chunk files
+     */
+    void set_spill_dir(const std::string& dir);
+
+    uint64_t hit_count() const noexcept { return m_hit_count; }
+    uint64_t miss_count() const noexcept { return m_miss_count; }
+
+private:
+    xlua_bytecode_cache();
+    std::string spill_dir();
+    static std::string spill_file(const std::string& dir, const std::string& hash);
+    bool spill_read(const std::string& hash, std::string& bytecode);
+    void spill_write(const std::string& hash, const std::string& bytecode);
+
+private:
+    std::mutex                                      m_lock;
+    basic::xlru_cache<std::string, std::string>     m_cache;
+    std::string                                     m_spill_dir;
+    std::atomic<uint64_t>                           m_hit_count{0};
+    std::atomic<uint64_t>                           m_miss_count{0};
+};
+NS_END2
@@ -4,31 +4,181 @@
 #include "xvm/xvm_lua_api.h"
 #include "xvm/xvm_engine.h"
 #include "xvm/xvm_context.h"
+#include "xvm/xlua_bytecode_cache.h"
+#include "xvm/xlua_state_pool.h"
 #include "xbasic/xscope_executer.h"
 #include "xerror/xvm_error.h"
 #include "xbase/xmem.h"
 #include "xbase/xcontext.h"
+#include "xdata/xproperty.h"
+
+#include <cstdlib>
 
 NS_BEG2(top, xvm)
 using base::xcontext_t;
 using base::xstream_t;
 
 xlua_engine::xlua_engine() {
-    m_lua_mgr = luaL_newstate();
+    // the pooled state already has the stdlib and chain api loaded
+    m_lua_mgr = xlua_state_pool::instance().acquire();
     if (m_lua_mgr == NULL) {
-        xerror_lua("luaL_newstate error\n");
+        xerror_lua("acquire lua state error\n");
         return;
     }
-    luaL_openlibs(m_lua_mgr);
 }
 
 void xlua_engine::register_function() {
+    // chain api is registered when the state is created, only restore the ones the contract shadowed
     for (size_t i = 0; i < sizeof(g_lua_chain_func) / sizeof(xlua_chain_func); i++) {
-        lua_register(m_lua_mgr, g_lua_chain_func[i].name, g_lua_chain_func[i].func);
+        lua_getglobal(m_lua_mgr, g_lua_chain_func[i].name);
+        bool shadowed = !xlua_state_pool::is_chain_function(m_lua_mgr, -1, i);
+        lua_pop(m_lua_mgr, 1);
+        if (shadowed) {
+            xlua_state_pool::register_chain_function(m_lua_mgr, i);
+        }
+    }
+}
+
+void xlua_engine::begin_memory_measure() {
+    // the state is reused, its size depends on what the node ran before. the limit is a
+    // consensus rule, so it only counts what is allocated from a collected baseline
+    lua_gc(m_lua_mgr, LUA_GCCOLLECT, 0);
+    xlua_state_pool::allocator(m_lua_mgr)->reset_peak();
+}
+
+void xlua_engine::check_memory_limit(int32_t status) {
+    auto allocator = xlua_state_pool::allocator(m_lua_mgr);
+    if (status == LUA_ERRMEM && allocator->limit_exceeded()) {
+        xkinfo_lua("lua memory limit exceeded, limit:%zu, base:%zu, peak:%zu", allocator->memory_limit(), allocator->memory_base(), allocator->memory_peak());
+        throw xvm_error{enum_xvm_error_code::enum_lua_memory_limit_exceeded, "lua memory limit " + std::to_string(allocator->memory_limit()) + " exceeded"};
+    }
+}
+
+// registry key of the tgas budget, only the address is used
+static char s_tgas_limit_key;
+// error object raised when the budget is used up, only the address is used
+static char s_tgas_abort_key;
+
+static bool lua_tgas_exceeded(lua_State* L) {
+    lua_rawgetp(L, LUA_REGISTRYINDEX, &s_tgas_limit_key);
+    auto tgas_limit = static_cast<uint64_t>(lua_tointeger(L, -1));
+    lua_pop(L, 1);
+    return tgas_limit != 0 && static_cast<uint64_t>(lua_getinstructioncount(L)) > tgas_limit;
+}
+
+static int lua_tgas_abort(lua_State* L) {
+    lua_pushlightuserdata(L, &s_tgas_abort_key);
+    return lua_error(L);
+}
+
+static void lua_tgas_hook(lua_State* L, lua_Debug* ar) {
+    if (lua_tgas_exceeded(L)) {
+        lua_tgas_abort(L);
+    }
+}
+
+// replaces pcall, xpcall and coroutine.resume: calls the original (upvalue 1) and raises
+// the abort again if the budget ran out inside, so the contract can't swallow it
+static int lua_guarded_protected_call(lua_State* L) {
+    lua_pushvalue(L, lua_upvalueindex(1));
+    lua_insert(L, 1);
+    lua_call(L, lua_gettop(L) - 1, LUA_MULTRET);
+    if (lua_tgas_exceeded(L)) {
+        return lua_tgas_abort(L);
+    }
+    return lua_gettop(L);
+}
+
+static void lua_guard_protected_call(lua_State* L, int tbl, const char* name) {
+    if (lua_getfield(L, tbl, name) != LUA_TFUNCTION) {
+        lua_pop(L, 1);
+        return;
+    }
+    lua_pushcclosure(L, lua_guarded_protected_call, 1);
+    lua_setfield(L, tbl, name);
+}
+
+void xlua_engine::guard_protected_calls(lua_State* L) {
+    lua_pushglobaltable(L);
+    lua_guard_protected_call(L, lua_gettop(L), "pcall");
+    lua_guard_protected_call(L, lua_gettop(L), "xpcall");
+    if (lua_getfield(L, -1, LUA_COLIBNAME) == LUA_TTABLE) {
+        lua_guard_protected_call(L, lua_gettop(L), "resume");
+    }
+    lua_pop(L, 2);
+}
+
+void xlua_engine::check_tgas_limit() {
+    auto instruction_count = static_cast<uint64_t>(lua_getinstructioncount(m_lua_mgr));
+    if (m_tgas_limit != 0 && instruction_count > m_tgas_limit) {
+        xkinfo_lua("tgas limit exceeded, limit:%llu, usage:%llu", static_cast<unsigned long long>(m_tgas_limit), static_cast<unsigned long long>(instruction_count));
+        throw xvm_error{enum_xvm_error_code::enum_lua_exec_tgas_limit_exceeded, "tgas limit " + std::to_string(m_tgas_limit) + " exceeded"};
+    }
+}
+
+void xlua_engine::pin_actions() {
+    unpin_actions();
+    // the stdlib and chain api are c functions, the lua functions in _G are exported by the contract
+    lua_pushglobaltable(m_lua_mgr);
+    lua_pushnil(m_lua_mgr);
+    while (lua_next(m_lua_mgr, -2) != 0) {
+        if (lua_type(m_lua_mgr, -2) == LUA_TSTRING && lua_isfunction(m_lua_mgr, -1) && !lua_iscfunction(m_lua_mgr, -1)) {
+            std::string name = lua_tostring(m_lua_mgr, -2);
+            if (name != "init") {
+                m_action_refs[name] = luaL_ref(m_lua_mgr, LUA_REGISTRYINDEX);
+                continue;
+            }
+        }
+        lua_pop(m_lua_mgr, 1);
     }
+    lua_pop(m_lua_mgr, 1);
 }
 
-void xlua_engine::validate_script(const std::string &code, xvm_context &ctx) {
+void xlua_engine::unpin_actions() {
+    if (m_lua_mgr != NULL) {
+        for (auto const & action : m_action_refs) {
+            luaL_unref(m_lua_mgr, LUA_REGISTRYINDEX, action.second);
+        }
+    }
+    m_action_refs.clear();
+}
+
+static int lua_bytecode_writer(lua_State* L, const void* p, size_t sz, void* ud) {
+    reinterpret_cast<std::string*>(ud)->append(reinterpret_cast<const char*>(p), sz);
+    return 0;
+}
+
+void xlua_engine::load_code(const std::string &code, bool use_cache) {
+    auto hash = xlua_bytecode_cache::code_hash(code);
+    std::string bytecode;
+    if (use_cache && xlua_bytecode_cache::instance().get(hash, bytecode)) {
+        // only binary chunks dumped by ourselves are accepted here
+        int32_t status = luaL_loadbufferx(m_lua_mgr, bytecode.data(), bytecode.size(), "=contract", "b");
+        if (status == LUA_OK) {
+            return;
+        }
+        check_memory_limit(status);
+        xwarn_lua("load cached bytecode error:%s", lua_tostring(m_lua_mgr, -1));
+        lua_pop(m_lua_mgr, 1);
+        bytecode.clear();
+    }
+
+    int32_t status = luaL_loadstring(m_lua_mgr, code.c_str());
+    if (status != LUA_OK) {
+        check_memory_limit(status);
+        string error_msg = lua_tostring(m_lua_mgr, -1);
+        xkinfo_lua("load lua code error\n %s", code.c_str());
+        throw xvm_error{enum_xvm_error_code::enum_lua_code_parse_error, "lua load code error:" + error_msg};
+    }
+
+    if (lua_dump(m_lua_mgr, lua_bytecode_writer, &bytecode, 0) == 0 && !bytecode.empty()) {
+        xlua_bytecode_cache::instance().put(hash, bytecode);
+    } else {
+        xwarn_lua("lua_dump code error");
+    }
+}
+
+void xlua_engine::validate_script(const std::string &code, xvm_context &ctx, bool use_cache) {
     try {
         if (ctx.m_contract_account.size() >= 64 ) {
             throw xvm_error{enum_xvm_error_code::enum_lua_code_owern_error, "contract account length error"};
@@ -38,18 +188,18 @@ void xlua_engine::validate_script(const std::string &code, xvm_context &ctx) {
         lua_setcontractaccount(m_lua_mgr, parent_addr.data(), parent_addr.size());
         lua_setuserdata(m_lua_mgr, reinterpret_cast<void*>(ctx.m_contract_helper.get()));
 
-        if (luaL_loadstring(m_lua_mgr, code.c_str())) {
-            string error_msg = lua_tostring(m_lua_mgr, -1);
-            xkinfo_lua("load lua code error\n %s", code.c_str());
-            throw xvm_error{enum_xvm_error_code::enum_lua_code_parse_error, "lua load code error:" + error_msg};
-        }
+        load_code(code, use_cache);
 
-        if (lua_pcall(m_lua_mgr, 0, 0, 0)) {
+        int32_t status = lua_pcall(m_lua_mgr, 0, 0, 0);
+        if (status != LUA_OK) {
+            check_memory_limit(status);
+            check_tgas_limit();
             string error_msg = lua_tostring(m_lua_mgr, -1);
             xkinfo_lua("lua_pcall validate:%s", error_msg.c_str());
             throw xvm_error{enum_xvm_error_code::enum_lua_code_parse_error, "lua_pcall validate error:" + error_msg};
         }
         register_function();
+        pin_actions();
     } catch(const xvm_error& e) {
         throw e;
     } catch(const std::exception& e) {
@@ -66,69 +216,74 @@ void xlua_engine::init_gas(xvm_context& ctx, int calc_gas) {
     // set netusage
     //lua_setgaslimit(m_lua_mgr, ctx.m_trace_ptr->m_gas_limit);
     lua_setcalltgas(m_lua_mgr, calc_gas);
+    // abort the running contract once the budget is used up
+    if (calc_gas == CALC_GAS_TRUE && m_tgas_limit != 0) {
+        lua_pushinteger(m_lua_mgr, static_cast<lua_Integer>(m_tgas_limit));
+        lua_rawsetp(m_lua_mgr, LUA_REGISTRYINDEX, &s_tgas_limit_key);
+        lua_sethook(m_lua_mgr, lua_tgas_hook, LUA_MASKCOUNT, LUA_TGAS_HOOK_STEP);
+    } else {
+        // the registry survives the pool reset, don't leave the budget of an earlier call behind
+        lua_pushinteger(m_lua_mgr, 0);
+        lua_rawsetp(m_lua_mgr, LUA_REGISTRYINDEX, &s_tgas_limit_key);
+        lua_sethook(m_lua_mgr, NULL, 0, 0);
+    }
 }
 
 void xlua_engine::publish_script(const string& code, xvm_context& ctx) {
     xtop_scope_executer on_exit([&ctx, this] {
         ctx.m_trace_ptr->m_instruction_usage = lua_getinstructioncount(this->m_lua_mgr);
+        ctx.m_trace_ptr->m_memory_peak = xlua_state_pool::allocator(this->m_lua_mgr)->memory_peak();
+        ctx.m_trace_ptr->m_alloc_count = static_cast<uint32_t>(xlua_state_pool::allocator(this->m_lua_mgr)->alloc_count());
     });
+    begin_memory_measure();
+    m_tgas_limit = ctx.m_tgas_limit;
+    m_abi = xlua_abi{ctx.m_abi};
     init_gas(ctx, CALC_GAS_TRUE);
     validate_script(code, ctx);
     call_init();
+    // init may define or replace actions
+    pin_actions();
+    check_tgas_limit();
 }
 
 void xlua_engine::load_script(const std::string &code, xvm_context &ctx) {
-    lua_clean(m_lua_mgr);
-    lua_setcalltgas(m_lua_mgr, CALC_GAS_FALSE);
-    validate_script(code, ctx);
+    auto tgas_limit = ctx.m_contract_helper->string_get2(data::XPROPERTY_CONTRACT_TGAS_LIMIT_KEY);
+    m_tgas_limit = tgas_limit.empty() ? 0 : std::strtoull(tgas_limit.c_str(), nullptr, 10);
+    m_abi = xlua_abi{ctx.m_contract_helper->string_get2(XPROPERTY_CONTRACT_ABI_KEY)};
+    begin_memory_measure();
+    init_gas(ctx, CALC_GAS_FALSE);
+    validate_script(code, ctx, true);
 }
 
 void xlua_engine::call_init() {
     int32_t ret = lua_getglobal(m_lua_mgr, "init");
-    if (ret != 0 && lua_pcall(m_lua_mgr, 0, 0, 0)) {
+    if (ret == 0) {
+        return;
+    }
+    int32_t status = lua_pcall(m_lua_mgr, 0, 0, 0);
+    if (status != LUA_OK) {
+        check_memory_limit(status);
+        check_tgas_limit();
         string error_msg = lua_tostring(m_lua_mgr, -1);
         xkinfo_lua("lua_pcall init:%s", error_msg.c_str());
         throw xvm_error{enum_xvm_error_code::enum_lua_code_pcall_error, "lua_pcall init error:" + error_msg};
     }
 }
 
-int32_t xlua_engine::arg_parse(const string& action_param) {
+int32_t xlua_engine::arg_parse(const string& action_name, const string& action_param) {
     int32_t argn{0};
     try {
-        if (!action_param.empty()) {
-            xstream_t stream(xcontext_t::instance(), (uint8_t*)action_param.data(), action_param.size());
-            uint8_t arg_num{0}, arg_type{0};
-            //int64_t arg_int64{0};
-            uint64_t arg_uint64{0};
-            string arg_str;
-            bool   arg_bool;
-            stream >> arg_num;
-            if (arg_num > MAX_ARG_NUM) {
-                throw xvm_error{enum_xvm_error_code::enum_lua_abi_input_error, "arg num " + std::to_string(arg_num) + " great than max number 16"};
-            }
-            argn = arg_num;
-            while (arg_num--) {
-                stream >> arg_type;
-                switch (arg_type) {
-                    case ARG_TYPE_UINT64:
-                        stream >> arg_uint64;
-                        lua_pushnumber(m_lua_mgr, arg_uint64);
-                        break;
-                    case ARG_TYPE_STRING:
-                        stream >> arg_str;
-                        if (arg_str.size() > MAX_ARG_STRING_SIZE) {
-                            throw xvm_error{enum_xvm_error_code::enum_lua_abi_input_error, "arg string size " + std::to_string(arg_str.size()) + " length greater than 128"};
-                        }
-                        lua_pushstring(m_lua_mgr, arg_str.c_str());
-                        break;
-                    case ARG_TYPE_BOOL:
-                        stream >> arg_bool;
-                        lua_pushboolean(m_lua_mgr, arg_bool);
-                        break;
-                    default:
-                        throw xvm_error{enum_xvm_error_code::enum_lua_abi_input_error, "param stream not valid"};
-                }
-            }
+        const std::vector<uint8_t>* arg_types = m_abi.empty() ? NULL : m_abi.find(action_name);
+        if (!m_abi.empty() && arg_types == NULL) {
+            throw xvm_error{enum_xvm_error_code::enum_lua_abi_input_name_or_type_error, "action " + action_name + " not in abi"};
+        }
+        xstream_t stream(xcontext_t::instance(), (uint8_t*)action_param.data(), action_param.size());
+        xlua_abi_decoder decoder(stream, arg_types);
+        int32_t status = decoder.push_args(m_lua_mgr, argn);
+        if (status != LUA_OK) {
+            check_memory_limit(status);
+            string error_msg = lua_tostring(m_lua_mgr, -1);
+            throw xvm_error{enum_xvm_error_code::enum_lua_abi_input_error, "decode param error:" + error_msg};
         }
     } catch(const xvm_error& e) {
         throw e;
@@ -147,7 +302,10 @@ void xlua_engine::process(common::xaccount_address_t const &contract_account, co
     xtop_scope_executer on_exit([&ctx, this] {
         ctx.m_trace_ptr->m_instruction_usage = lua_getinstructioncount(this->m_lua_mgr);
         ctx.m_contract_helper->get_gas_and_disk_usage(ctx.m_trace_ptr->m_tgas_usage, ctx.m_trace_ptr->m_disk_usage);
+        ctx.m_trace_ptr->m_memory_peak = xlua_state_pool::allocator(this->m_lua_mgr)->memory_peak();
+        ctx.m_trace_ptr->m_alloc_count = static_cast<uint32_t>(xlua_state_pool::allocator(this->m_lua_mgr)->alloc_count());
     });
+    begin_memory_measure();
     if (ctx.m_exec_account.size() >= 64) {
         throw xvm_error{enum_xvm_error_code::enum_lua_code_owern_error, "contract m_exec_account length error"};
     }
@@ -155,18 +313,30 @@ void xlua_engine::process(common::xaccount_address_t const &contract_account, co
     lua_setuserdata(m_lua_mgr, reinterpret_cast<void*>(ctx.m_contract_helper.get()));
     init_gas(ctx, CALC_GAS_TRUE);
 
-    lua_getglobal(m_lua_mgr, ctx.m_current_action.get_action_name().c_str());
-
     try {
-        if (ctx.m_current_action.get_action_name() == "init") {
+        auto const & action_name = ctx.m_current_action.get_action_name();
+        if (action_name == "init") {
             throw xvm_error{enum_xvm_error_code::enum_lua_abi_input_error, "can't call init function"};
         }
+        // actions are pinned after the chunk and init ran, a global defined later is looked up
+        auto iter = m_action_refs.find(action_name);
+        if (iter != m_action_refs.end()) {
+            lua_rawgeti(m_lua_mgr, LUA_REGISTRYINDEX, iter->second);
+        } else if (lua_getglobal(m_lua_mgr, action_name.c_str()) == LUA_TNIL) {
+            lua_pop(m_lua_mgr, 1);
+            throw xvm_error{enum_xvm_error_code::enum_vm_no_func_find, "action " + action_name + " not found"};
+        }
 
-        if (lua_pcall(m_lua_mgr, arg_parse(ctx.m_current_action.get_action_param()), 0, 0)) {
+        int32_t status = lua_pcall(m_lua_mgr, arg_parse(action_name, ctx.m_current_action.get_action_param()), 0, 0);
+        if (status != LUA_OK) {
+            check_memory_limit(status);
+            check_tgas_limit();
             string error_msg = lua_tostring(m_lua_mgr, -1);
             xkinfo_lua("lua_pcall:%s", error_msg.c_str());
             throw xvm_error{enum_xvm_error_code::enum_lua_code_pcall_error,  "lua_pcall error:" + error_msg};
         }
+        // host calls add instructions too, so the budget may be passed after the last hook check
+        check_tgas_limit();
     } catch(const xvm_error& e) {
         throw e;
     } catch(const std::exception& e) {
@@ -177,10 +347,19 @@ void xlua_engine::process(common::xaccount_address_t const &contract_account, co
     }
 }
 
+std::size_t xlua_engine::memory_usage() const {
+    if (m_lua_mgr == NULL) {
+        return 0;
+    }
+    return static_cast<std::size_t>(lua_gc(m_lua_mgr, LUA_GCCOUNT, 0)) * 1024 + lua_gc(m_lua_mgr, LUA_GCCOUNTB, 0);
+}
+
 void xlua_engine::close() {
     xdbg("close xlua_engine");
     if (m_lua_mgr != NULL) {
-        lua_close(m_lua_mgr);
+        // the registry survives the pool reset, drop the refs before giving the state back
+        unpin_actions();
+        xlua_state_pool::instance().release(m_lua_mgr);
         m_lua_mgr = NULL;
     }
 }
@@ -6,7 +6,9 @@
 #include <string>
 #include <cstdint>
 #include <mutex>
+#include <unordered_map>
 #include "xvm/xvm_engine.h"
+#include "xvm/xlua_abi.h"
 extern "C"
 {
 	#include <lua.h>
@@ -18,6 +20,7 @@ NS_BEG2(top, xvm)
 #define CALC_GAS_FALSE  0
 #define MAX_ARG_NUM     16
 #define MAX_ARG_STRING_SIZE 128
+#define LUA_TGAS_HOOK_STEP  1000    // check the tgas budget every LUA_TGAS_HOOK_STEP instructions
 
 class xlua_engine : public xengine, public std::enable_shared_from_this<xlua_engine>
 {
@@ -25,15 +28,34 @@ public:
     xlua_engine();
     ~xlua_engine();
     void process(common::xaccount_address_t const & contract_account, const string& code, xvm_context& ctx) override;
-    void validate_script(const string& code, xvm_context& ctx);
+    void validate_script(const string& code, xvm_context& ctx, bool use_cache = false);
     void publish_script(const string& code, xvm_context& ctx) override;
     void load_script(const std::string &code, xvm_context &ctx) override;
+    std::size_t memory_usage() const override;
     void call_init();
     void close();
     void register_function();
     void init_gas(xvm_context& ctx, int calc_gas);
-    int32_t arg_parse(const string& action_param);
+    int32_t arg_parse(const string& action_name, const string& action_param);
+    /**
+     * @brief wrap pcall, xpcall and coroutine.resume of a new state, so that the abort raised
+     *        when the tgas budget is used up can't be caught by the contract
+     *
+     * @param L  the state
+     */
+    static void guard_protected_calls(lua_State* L);
+private:
+    void load_code(const std::string& code, bool use_cache);
+    // collect the garbage left by earlier calls and start measuring the memory of this call
+    void begin_memory_measure();
+    void check_memory_limit(int32_t status);
+    void check_tgas_limit();
+    void pin_actions();
+    void unpin_actions();
 private:
     lua_State* m_lua_mgr;
+    std::unordered_map<std::string, int> m_action_refs;   // action name -> registry ref of the lua function
+    xlua_abi   m_abi;
+    uint64_t   m_tgas_limit{0};     // one instruction costs one tgas, 0 means no limit
 };
 NS_END2
@@ -0,0 +1,463 @@
+// Copyright (c) 2017-2018 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+#include "xvm/xlua_state_pool.h"
+#include "xvm/xlua_engine.h"
+#include "xvm/xvm_lua_api.h"
+#include "xmetrics/xmetrics.h"
+
+NS_BEG2(top, xvm)
+
+// registry key of the snapshot thread, only the address is used
+static char s_snapshot_key;
+
+// slots of the snapshot thread's stack
+#define LUA_SNAPSHOT_TABLES             1
+#define LUA_SNAPSHOT_METATABLES         2
+#define LUA_SNAPSHOT_UPVALUES           3
+#define LUA_SNAPSHOT_USERVALUES         4
+#define LUA_SNAPSHOT_STRING_METATABLE   5
+
+/**
+ * snapshot layout, on the stack of a thread anchored at registry[&s_snapshot_key]. a thread
+ * stack can't be reached from lua, while the registry can through debug.getregistry:
+ *   [LUA_SNAPSHOT_TABLES][tbl]         = shallow copy of tbl
+ *   [LUA_SNAPSHOT_METATABLES][obj]     = metatable of the table or full userdata obj
+ *   [LUA_SNAPSHOT_UPVALUES][func]      = the upvalues of func, with the count in field n
+ *   [LUA_SNAPSHOT_USERVALUES][ud]      = {user value of the full userdata ud}
+ *   [LUA_SNAPSHOT_STRING_METATABLE]    = metatable of string values
+ * the objects are the registry and everything reachable from it or from the string metatable
+ * when the state is created, i.e. _G, the stdlib, package.loaded and the chain api. the debug
+ * library can change any of them, the reset puts them all back
+ */
+struct xlua_snapshot_t {
+    int tables;
+    int metatables;
+    int upvalues;
+    int uservalues;
+};
+
+static void snapshot_value(lua_State* L, const xlua_snapshot_t& snapshot, int idx);
+
+static void snapshot_metatable(lua_State* L, const xlua_snapshot_t& snapshot, int obj) {
+    if (lua_getmetatable(L, obj)) {
+        snapshot_value(L, snapshot, -1);
+        lua_pushvalue(L, obj);
+        lua_insert(L, -2);
+        lua_rawset(L, snapshot.metatables);
+    }
+}
+
+static void snapshot_table(lua_State* L, const xlua_snapshot_t& snapshot, int tbl) {
+    lua_pushvalue(L, tbl);
+    if (lua_rawget(L, snapshot.tables) != LUA_TNIL) {  // already done
+        lua_pop(L, 1);
+        return;
+    }
+    lua_pop(L, 1);
+
+    // recorded before the fields are walked, so cycles like _G._G end here
+    lua_newtable(L);
+    int copy = lua_gettop(L);
+    lua_pushvalue(L, tbl);
+    lua_pushvalue(L, copy);
+    lua_rawset(L, snapshot.tables);
+    lua_pushnil(L);
+    while (lua_next(L, tbl) != 0) {
+        lua_pushvalue(L, -2);
+        lua_pushvalue(L, -2);
+        lua_rawset(L, copy);
+        snapshot_value(L, snapshot, -1);
+        lua_pop(L, 1);
+    }
+    lua_pop(L, 1);
+    snapshot_metatable(L, snapshot, tbl);
+}
+
+static void snapshot_function(lua_State* L, const xlua_snapshot_t& snapshot, int func) {
+    if (lua_getupvalue(L, func, 1) == NULL) {  // light c functions have none
+        return;
+    }
+    lua_pop(L, 1);
+    lua_pushvalue(L, func);
+    if (lua_rawget(L, snapshot.upvalues) != LUA_TNIL) {
+        lua_pop(L, 1);
+        return;
+    }
+    lua_pop(L, 1);
+
+    lua_newtable(L);
+    int values = lua_gettop(L);
+    lua_pushvalue(L, func);
+    lua_pushvalue(L, values);
+    lua_rawset(L, snapshot.upvalues);
+    int n = 0;
+    while (lua_getupvalue(L, func, n + 1) != NULL) {
+        snapshot_value(L, snapshot, -1);
+        lua_rawseti(L, values, ++n);
+    }
+    lua_pushinteger(L, n);
+    lua_setfield(L, values, "n");
+    lua_pop(L, 1);
+}
+
+static void snapshot_userdata(lua_State* L, const xlua_snapshot_t& snapshot, int ud) {
+    lua_pushvalue(L, ud);
+    if (lua_rawget(L, snapshot.uservalues) != LUA_TNIL) {
+        lua_pop(L, 1);
+        return;
+    }
+    lua_pop(L, 1);
+
+    lua_newtable(L);
+    lua_pushvalue(L, ud);
+    lua_pushvalue(L, -2);
+    lua_rawset(L, snapshot.uservalues);
+    lua_getuservalue(L, ud);
+    snapshot_value(L, snapshot, -1);
+    lua_rawseti(L, -2, 1);
+    lua_pop(L, 1);
+    snapshot_metatable(L, snapshot, ud);
+}
+
+static void snapshot_value(lua_State* L, const xlua_snapshot_t& snapshot, int idx) {
+    idx = lua_absindex(L, idx);
+    luaL_checkstack(L, 8, "lua state snapshot too deep");
+    switch (lua_type(L, idx)) {
+    case LUA_TTABLE:
+        snapshot_table(L, snapshot, idx);
+        break;
+    case LUA_TFUNCTION:
+        snapshot_function(L, snapshot, idx);
+        break;
+    case LUA_TUSERDATA:
+        snapshot_userdata(L, snapshot, idx);
+        break;
+    default:
+        break;
+    }
+}
+
+static int snapshot_state(lua_State* L) {
+    lua_newtable(L);
+    lua_newtable(L);
+    lua_newtable(L);
+    lua_newtable(L);
+    xlua_snapshot_t snapshot{lua_absindex(L, -4), lua_absindex(L, -3), lua_absindex(L, -2), lua_absindex(L, -1)};
+
+    lua_pushvalue(L, LUA_REGISTRYINDEX);
+    snapshot_value(L, snapshot, -1);
+    lua_pop(L, 1);
+
+    lua_pushliteral(L, "");
+    if (!lua_getmetatable(L, -1)) {
+        lua_pushnil(L);
+    }
+    snapshot_value(L, snapshot, -1);
+    lua_remove(L, -2);
+
+    // move the snapshot to its thread, and keep the anchor when the registry is restored
+    lua_State* T = lua_newthread(L);
+    lua_pushvalue(L, LUA_REGISTRYINDEX);
+    lua_rawget(L, snapshot.tables);
+    lua_pushvalue(L, -2);
+    lua_rawsetp(L, -2, &s_snapshot_key);
+    lua_pop(L, 1);
+    lua_rawsetp(L, LUA_REGISTRYINDEX, &s_snapshot_key);
+    lua_xmove(L, T, 5);
+    return 0;
+}
+
+static void restore_table(lua_State* L, int tbl, int copy) {
+    // existing fields may be changed or cleared while traversing
+    lua_pushnil(L);
+    while (lua_next(L, tbl) != 0) {
+        lua_pushvalue(L, -2);
+        lua_rawget(L, copy);
+        if (!lua_rawequal(L, -1, -2)) {
+            lua_pushvalue(L, -3);
+            lua_insert(L, -2);
+            lua_rawset(L, tbl);
+        } else {
+            lua_pop(L, 1);
+        }
+        lua_pop(L, 1);
+    }
+    // then add back the removed fields
+    lua_pushnil(L);
+    while (lua_next(L, copy) != 0) {
+        lua_pushvalue(L, -2);
+        if (lua_rawget(L, tbl) == LUA_TNIL) {
+            lua_pushvalue(L, -3);
+            lua_pushvalue(L, -3);
+            lua_rawset(L, tbl);
+        }
+        lua_pop(L, 2);
+    }
+}
+
+static int reset_state(lua_State* L) {
+    lua_rawgetp(L, LUA_REGISTRYINDEX, &s_snapshot_key);
+    lua_State* T = lua_tothread(L, -1);
+    // a contract can reach the thread through the registry, resuming it breaks the snapshot
+    if (T == NULL || lua_status(T) != LUA_OK || lua_gettop(T) != 5) {
+        return luaL_error(L, "lua state snapshot not found");
+    }
+    for (int i = 1; i <= 5; i++) {
+        lua_pushvalue(T, i);
+        lua_xmove(T, L, 1);
+    }
+    xlua_snapshot_t snapshot{lua_absindex(L, -5), lua_absindex(L, -4), lua_absindex(L, -3), lua_absindex(L, -2)};
+    int string_metatable = lua_absindex(L, -1);
+
+    lua_pushnil(L);
+    while (lua_next(L, snapshot.tables) != 0) {
+        int tbl = lua_absindex(L, -2);
+        restore_table(L, tbl, lua_absindex(L, -1));
+        lua_pushvalue(L, tbl);
+        lua_rawget(L, snapshot.metatables);
+        lua_setmetatable(L, tbl);
+        lua_pop(L, 1);
+    }
+
+    lua_pushnil(L);
+    while (lua_next(L, snapshot.upvalues) != 0) {
+        int func = lua_absindex(L, -2);
+        int values = lua_absindex(L, -1);
+        lua_getfield(L, values, "n");
+        auto n = static_cast<int>(lua_tointeger(L, -1));
+        lua_pop(L, 1);
+        for (int i = 1; i <= n; i++) {
+            lua_rawgeti(L, values, i);
+            if (lua_setupvalue(L, func, i) == NULL) {
+                lua_pop(L, 1);
+            }
+        }
+        lua_pop(L, 1);
+    }
+
+    lua_pushnil(L);
+    while (lua_next(L, snapshot.uservalues) != 0) {
+        int ud = lua_absindex(L, -2);
+        lua_rawgeti(L, -1, 1);
+        lua_setuservalue(L, ud);
+        lua_pushvalue(L, ud);
+        lua_rawget(L, snapshot.metatables);
+        lua_setmetatable(L, ud);
+        lua_pop(L, 1);
+    }
+
+    lua_pushliteral(L, "");
+    lua_pushvalue(L, string_metatable);
+    lua_setmetatable(L, -2);
+    lua_pop(L, 1);
+
+    // the other basic types have no metatable in a new state
+    lua_pushnil(L);
+    lua_pushboolean(L, 0);
+    lua_pushinteger(L, 0);
+    lua_pushlightuserdata(L, NULL);
+    lua_pushcfunction(L, reset_state);
+    lua_pushthread(L);
+    for (int i = 0; i < 6; i++) {
+        lua_pushnil(L);
+        lua_setmetatable(L, -2);
+        lua_pop(L, 1);
+    }
+    return 0;
+}
+
+static int lua_state_panic(lua_State* L) {
+    xerror_lua("unprotected error in call to Lua API (%s)", lua_tostring(L, -1));
+    return 0;
+}
+
+xlua_state_pool& xlua_state_pool::instance() {
+    static xlua_state_pool * inst = new xlua_state_pool();
+    return *inst;
+}
+
+xlua_state_pool::xlua_state_pool() {
+    prewarm(LUA_STATE_POOL_PREWARM);
+}
+
+xlua_state_pool::~xlua_state_pool() {
+    for (auto L : m_states) {
+        close_state(L);
+    }
+    m_states.clear();
+}
+
+// bytes of the strings in the stack slots [from, to]
+static uint64_t lua_stack_bytes(lua_State *L, int from, int to) {
+    uint64_t bytes{0};
+    for (int i = from; i <= to; i++) {
+        if (lua_type(L, i) == LUA_TSTRING) {
+            bytes += lua_rawlen(L, i);
+        }
+    }
+    return bytes;
+}
+
+// calls the chain function of upvalue 1, timed only when the contract helper has a profile
+static int L_chain_call(lua_State *L) {
+    auto idx = static_cast<size_t>(lua_tointeger(L, lua_upvalueindex(1)));
+    xcontract_helper* contract_helper = reinterpret_cast<xcontract_helper*>(lua_getuserdata(L));
+    if (contract_helper == nullptr || contract_helper->profile() == nullptr) {
+        return g_lua_chain_func[idx].func(L);
+    }
+    top::xvm::xhost_call_scope_t scope(contract_helper->profile(), g_lua_chain_func[idx].name, lua_stack_bytes(L, 1, lua_gettop(L)));
+    int nresults = g_lua_chain_func[idx].func(L);
+    scope.add_bytes(lua_stack_bytes(L, lua_gettop(L) - nresults + 1, lua_gettop(L)));
+    return nresults;
+}
+
+void xlua_state_pool::register_chain_function(lua_State* L, size_t idx) {
+    lua_pushinteger(L, static_cast<lua_Integer>(idx));
+    lua_pushcclosure(L, L_chain_call, 1);
+    lua_setglobal(L, g_lua_chain_func[idx].name);
+}
+
+bool xlua_state_pool::is_chain_function(lua_State* L, int index, size_t idx) {
+    if (lua_tocfunction(L, index) != L_chain_call || lua_getupvalue(L, index, 1) == NULL) {
+        return false;
+    }
+    bool same = static_cast<size_t>(lua_tointeger(L, -1)) == idx;
+    lua_pop(L, 1);
+    return same;
+}
+
+void xlua_state_pool::register_chain_functions(lua_State* L) {
+    for (size_t i = 0; i < sizeof(g_lua_chain_func) / sizeof(xlua_chain_func); i++) {
+        register_chain_function(L, i);
+    }
+}
+
+xlua_allocator* xlua_state_pool::allocator(lua_State* L) {
+    void* ud{NULL};
+    lua_getallocf(L, &ud);
+    return reinterpret_cast<xlua_allocator*>(ud);
+}
+
+void xlua_state_pool::close_state(lua_State* L) {
+    auto alloc = allocator(L);
+    lua_close(L);
+    delete alloc;
+}
+
+lua_State* xlua_state_pool::create() {
+    auto alloc = new xlua_allocator(m_memory_limit);
+    lua_State* L = lua_newstate(xlua_allocator::alloc, alloc);
+    if (L == NULL) {
+        xerror_lua("lua_newstate error\n");
+        delete alloc;
+        return NULL;
+    }
+    lua_atpanic(L, lua_state_panic);
+    luaL_openlibs(L);
+    set_gc_params(L);
+    xlua_engine::guard_protected_calls(L);
+    register_chain_functions(L);
+    lua_pushcfunction(L, snapshot_state);
+    if (lua_pcall(L, 0, 0, 0) != LUA_OK) {
+        xerror_lua("snapshot lua state error:%s", lua_tostring(L, -1));
+        close_state(L);
+        return NULL;
+    }
+    return L;
+}
+
+lua_State* xlua_state_pool::acquire() {
+    lua_State* L{NULL};
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (!m_states.empty()) {
+            L = m_states.back();
+            m_states.pop_back();
+        }
+    }
+    if (L != NULL) {
+        XMETRICS_COUNTER_INCREMENT("xvm_lua_state_pool_hit", 1);
+    } else {
+        XMETRICS_COUNTER_INCREMENT("xvm_lua_state_pool_miss", 1);
+        L = create();
+    }
+    if (L != NULL) {
+        allocator(L)->set_memory_limit(m_memory_limit);
+    }
+    return L;
+}
+
+bool xlua_state_pool::reset(lua_State* L) {
+    lua_settop(L, 0);
+    lua_sethook(L, NULL, 0, 0);
+    lua_pushcfunction(L, reset_state);
+    if (lua_pcall(L, 0, 0, 0) != LUA_OK) {
+        xwarn_lua("reset lua state error:%s", lua_tostring(L, -1));
+        return false;
+    }
+    lua_setuserdata(L, NULL);
+    lua_clean(L);
+    set_gc_params(L);
+    lua_gc(L, LUA_GCCOLLECT, 0);
+    allocator(L)->reset_peak();
+    return true;
+}
+
+void xlua_state_pool::set_gc_params(lua_State* L) {
+    // collectgarbage("stop"), "setpause" and "setstepmul" of a contract must not outlive it
+    lua_gc(L, LUA_GCRESTART, 0);
+    lua_gc(L, LUA_GCSETPAUSE, LUA_STATE_GC_PAUSE);
+    lua_gc(L, LUA_GCSETSTEPMUL, LUA_STATE_GC_STEPMUL);
+}
+
+void xlua_state_pool::release(lua_State* L) {
+    if (L == NULL) {
+        return;
+    }
+    if (size() < m_capacity && reset(L)) {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (m_states.size() < m_capacity) {
+            m_states.push_back(L);
+            return;
+        }
+    }
+    close_state(L);
+}
+
+void xlua_state_pool::prewarm(std::size_t count) {
+    while (size() < count) {
+        lua_State* L = create();
+        if (L == NULL) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_states.push_back(L);
+    }
+}
+
+void xlua_state_pool::set_capacity(std::size_t capacity) {
+    std::vector<lua_State*> closed;
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_capacity = capacity;
+        while (m_states.size() > m_capacity) {
+            closed.push_back(m_states.back());
+            m_states.pop_back();
+        }
+    }
+    for (auto L : closed) {
+        close_state(L);
+    }
+}
+
+void xlua_state_pool::set_memory_limit(std::size_t memory_limit) {
+    m_memory_limit = memory_limit;
+}
+
+std::size_t xlua_state_pool::size() const {
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_states.size();
+}
+
+NS_END2
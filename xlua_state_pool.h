@@ -0,0 +1,115 @@
+// Copyright (c) 2017-2018 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "xbasic/xns_macro.h"
+#include "xlua_allocator.h"
+extern "C"
+{
+	#include <lua.h>
+	#include <lualib.h>
+	#include <lauxlib.h>
+}
+NS_BEG2(top, xvm)
+#define LUA_STATE_POOL_CAPACITY     64
+#define LUA_STATE_POOL_PREWARM      8
+#define LUA_STATE_GC_PAUSE          200     // the lua defaults
+#define LUA_STATE_GC_STEPMUL        200
+
+/**
+ * @brief pool of warm lua states, which already have the stdlib and chain api
+ *        loaded. a released state is reset to the tables, metatables and gc parameters it had
+ *        when it was created
+ *
+ */
+class xlua_state_pool {
+public:
+    static xlua_state_pool& instance();
+    ~xlua_state_pool();
+
+    /**
+     * @brief borrow a warm state, create a new one if the pool is empty
+     *
+     * @return lua_State*  the state, NULL if create failed
+     */
+    lua_State* acquire();
+
+    /**
+     * @brief give back the state, it is closed if it can't be reset or the pool is full
+     *
+     * @param L  the state
+     */
+    void release(lua_State* L);
+
+    /**
+     * @brief create states until the pool holds count states
+     *
+     * @param count  the number of states
+     */
+    void prewarm(std::size_t count);
+
+    void set_capacity(std::size_t capacity);
+    std::size_t size() const;
+
+    /**
+     * @brief Set the memory limit of each contract, applied to the states acquired later
+     *
+     * @param memory_limit  the limit in bytes
+     */
+    void set_memory_limit(std::size_t memory_limit);
+
+    /**
+     * @brief get the allocator of the state created by the pool
+     *
+     * @param L  the state
+     * @return xlua_allocator*  the allocator
+     */
+    static xlua_allocator* allocator(lua_State* L);
+
+    /**
+     * @brief close the state and free its allocator
+     *
+     * @param L  the state
+     */
+    static void close_state(lua_State* L);
+
+    /**
+     * @brief register the chain api functions to the state
+     *
+     * @param L  the state
+     */
+    static void register_chain_functions(lua_State* L);
+
+    /**
+     * @brief register the chain api function idx of g_lua_chain_func, as a closure of the one
+     *        dispatcher defined in xlua_state_pool.cpp
+     *
+     * @param L  the state
+     * @param idx  the index in g_lua_chain_func
+     */
+    static void register_chain_function(lua_State* L, size_t idx);
+
+    /**
+     * @brief whether the value at index is the chain api function idx registered by register_chain_function
+     *
+     */
+    static bool is_chain_function(lua_State* L, int index, size_t idx);
+
+private:
+    xlua_state_pool();
+    lua_State* create();
+    bool reset(lua_State* L);
+    static void set_gc_params(lua_State* L);
+
+private:
+    mutable std::mutex          m_lock;
+    std::vector<lua_State*>     m_states;
+    std::atomic<std::size_t>    m_capacity{LUA_STATE_POOL_CAPACITY};
+    std::atomic<std::size_t>    m_memory_limit{LUA_MEMORY_LIMIT_DEFAULT};
+};
+NS_END2
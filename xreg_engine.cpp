@@ -0,0 +1,469 @@
+// Copyright (c) 2017-2018 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+#include "xvm/xreg_engine.h"
+#include "xvm/xvm_context.h"
+#include "xbasic/xscope_executer.h"
+#include "xerror/xvm_error.h"
+#include "xbase/xmem.h"
+#include "xbase/xcontext.h"
+#include "xdata/xproperty.h"
+
+#include <cerrno>
+#include <cstdlib>
+
+NS_BEG2(top, xvm)
+using base::xcontext_t;
+using base::xstream_t;
+using enum_xreg_opcode = xreg_engine::enum_xreg_opcode;
+
+struct xreg_opcode_info_t {
+    const char*         name;
+    enum_xreg_opcode    op;
+    const char*         operands;   // r register, i integer, s string, l label
+};
+
+static const xreg_opcode_info_t g_xreg_opcodes[] = {
+    { "loadi",      enum_xreg_opcode::loadi,    "ri" },
+    { "loads",      enum_xreg_opcode::loads,    "rs" },
+    { "arg",        enum_xreg_opcode::arg,      "ri" },
+    { "mov",        enum_xreg_opcode::mov,      "rr" },
+    { "add",        enum_xreg_opcode::add,      "rrr" },
+    { "sub",        enum_xreg_opcode::sub,      "rrr" },
+    { "mul",        enum_xreg_opcode::mul,      "rrr" },
+    { "div",        enum_xreg_opcode::div,      "rrr" },
+    { "mod",        enum_xreg_opcode::mod,      "rrr" },
+    { "concat",     enum_xreg_opcode::concat,   "rrr" },
+    { "eq",         enum_xreg_opcode::eq,       "rrr" },
+    { "lt",         enum_xreg_opcode::lt,       "rrr" },
+    { "le",         enum_xreg_opcode::le,       "rrr" },
+    { "jmp",        enum_xreg_opcode::jmp,      "l" },
+    { "jz",         enum_xreg_opcode::jz,       "rl" },
+    { "jnz",        enum_xreg_opcode::jnz,      "rl" },
+    { "toint",      enum_xreg_opcode::toint,    "rr" },
+    { "tostr",      enum_xreg_opcode::tostr,    "rr" },
+    { "get",        enum_xreg_opcode::get,      "rr" },
+    { "set",        enum_xreg_opcode::set,      "rr" },
+    { "hget",       enum_xreg_opcode::hget,     "rrr" },
+    { "hset",       enum_xreg_opcode::hset,     "rrr" },
+    { "require",    enum_xreg_opcode::require,  "rs" },
+    { "ret",        enum_xreg_opcode::ret,      "" },
+};
+
+static xvm_error parse_error(uint32_t line_no, const std::string& msg) {
+    return xvm_error{enum_xvm_error_code::enum_vm_code_parse_error, "line " + std::to_string(line_no) + ": " + msg};
+}
+
+// split the line into tokens, a quoted string is one token and ';' starts a comment
+static std::vector<std::string> tokenize(const std::string& line, uint32_t line_no) {
+    std::vector<std::string> tokens;
+    std::size_t i{0};
+    while (i < line.size()) {
+        char ch = line[i];
+        if (ch == ' ' || ch == '\t' || ch == '\r' || ch == ',') {
+            i++;
+        } else if (ch == ';') {
+            break;
+        } else if (ch == '"') {
+            auto end = line.find('"', i + 1);
+            if (end == std::string::npos) {
+                throw parse_error(line_no, "string not closed");
+            }
+            tokens.push_back(line.substr(i, end - i + 1));
+            i = end + 1;
+        } else {
+            auto begin = i;
+            while (i < line.size() && line[i] != ' ' && line[i] != '\t' && line[i] != '\r' && line[i] != ',' && line[i] != ';') {
+                i++;
+            }
+            tokens.push_back(line.substr(begin, i - begin));
+        }
+    }
+    return tokens;
+}
+
+static bool parse_int(const std::string& token, int64_t& value) {
+    if (token.empty()) {
+        return false;
+    }
+    char* end{nullptr};
+    errno = 0;
+    value = std::strtoll(token.c_str(), &end, 10);
+    return errno == 0 && end != nullptr && *end == '\0';
+}
+
+static uint8_t parse_register(const std::string& token, uint32_t line_no) {
+    int64_t idx{0};
+    if (token.size() < 2 || token[0] != 'r' || !parse_int(token.substr(1), idx) || idx < 0 || idx >= XREG_REGISTER_NUM) {
+        throw parse_error(line_no, "bad register " + token);
+    }
+    return static_cast<uint8_t>(idx);
+}
+
+void xreg_engine::compile(const std::string& code) {
+    if (code.compare(0, sizeof(XREG_ENGINE_HEADER) - 1, XREG_ENGINE_HEADER) != 0) {
+        throw xvm_error{enum_xvm_error_code::enum_vm_code_parse_error, "code header not match"};
+    }
+    m_functions.clear();
+    m_constants.clear();
+
+    struct xpending_jump_t {
+        std::size_t     pc;
+        std::string     label;
+        uint32_t        line_no;
+    };
+    xreg_function_t* func{nullptr};
+    std::string func_name;
+    std::unordered_map<std::string, std::size_t> labels;
+    std::vector<xpending_jump_t> jumps;
+
+    uint32_t line_no{1};
+    std::size_t begin = sizeof(XREG_ENGINE_HEADER) - 1;
+    while (begin < code.size()) {
+        auto end = code.find('\n', begin);
+        if (end == std::string::npos) {
+            end = code.size();
+        }
+        auto tokens = tokenize(code.substr(begin, end - begin), ++line_no);
+        begin = end + 1;
+        if (tokens.empty()) {
+            continue;
+        }
+
+        if (func == nullptr) {
+            int64_t arg_num{0};
+            if (tokens.size() != 3 || tokens[0] != "action" || !parse_int(tokens[2], arg_num) || arg_num < 0 || arg_num > MAX_ARG_NUM) {
+                throw parse_error(line_no, "expect: action <name> <arg num>");
+            }
+            if (m_functions.find(tokens[1]) != m_functions.end()) {
+                throw parse_error(line_no, "action " + tokens[1] + " redefined");
+            }
+            func_name = tokens[1];
+            func = &m_functions[func_name];
+            func->arg_num = static_cast<uint8_t>(arg_num);
+            continue;
+        }
+
+        if (tokens.size() == 1 && tokens[0] == "end") {
+            for (auto const & jump : jumps) {
+                auto iter = labels.find(jump.label);
+                if (iter == labels.end()) {
+                    throw parse_error(jump.line_no, "label " + jump.label + " not found in " + func_name);
+                }
+                func->code[jump.pc].imm = static_cast<int64_t>(iter->second);
+            }
+            // falling off the end returns
+            func->code.push_back(xreg_instruction_t{enum_xreg_opcode::ret});
+            func = nullptr;
+            labels.clear();
+            jumps.clear();
+            continue;
+        }
+
+        if (tokens.size() == 1 && tokens[0].back() == ':') {
+            auto label = tokens[0].substr(0, tokens[0].size() - 1);
+            if (label.empty() || !labels.emplace(label, func->code.size()).second) {
+                throw parse_error(line_no, "bad label " + tokens[0]);
+            }
+            continue;
+        }
+
+        const xreg_opcode_info_t* info{nullptr};
+        for (auto const & opcode : g_xreg_opcodes) {
+            if (tokens[0] == opcode.name) {
+                info = &opcode;
+                break;
+            }
+        }
+        if (info == nullptr) {
+            throw parse_error(line_no, "unknown instruction " + tokens[0]);
+        }
+        std::string operands{info->operands};
+        if (tokens.size() != operands.size() + 1) {
+            throw parse_error(line_no, tokens[0] + " expects " + std::to_string(operands.size()) + " operands");
+        }
+
+        xreg_instruction_t ins{info->op};
+        uint8_t* regs[] = {&ins.a, &ins.b, &ins.c};
+        std::size_t reg_idx{0};
+        for (std::size_t i = 0; i < operands.size(); i++) {
+            auto const & token = tokens[i + 1];
+            switch (operands[i]) {
+                case 'r':
+                    *regs[reg_idx++] = parse_register(token, line_no);
+                    break;
+                case 'i':
+                    if (!parse_int(token, ins.imm)) {
+                        throw parse_error(line_no, "bad integer " + token);
+                    }
+                    break;
+                case 's':
+                    if (token.size() < 2 || token.front() != '"' || token.back() != '"') {
+                        throw parse_error(line_no, "bad string " + token);
+                    }
+                    ins.konst = static_cast<uint32_t>(m_constants.size());
+                    m_constants.push_back(token.substr(1, token.size() - 2));
+                    break;
+                case 'l':
+                    jumps.push_back(xpending_jump_t{func->code.size(), token, line_no});
+                    break;
+            }
+        }
+        if (ins.op == enum_xreg_opcode::arg && (ins.imm < 0 || ins.imm >= func->arg_num)) {
+            throw parse_error(line_no, "arg index out of range");
+        }
+        func->code.push_back(ins);
+    }
+    if (func != nullptr) {
+        throw parse_error(line_no, "action " + func_name + " not ended");
+    }
+}
+
+std::vector<xreg_engine::xreg_value_t> xreg_engine::arg_parse(const std::string& action_param) {
+    std::vector<xreg_value_t> args;
+    try {
+        if (action_param.empty()) {
+            return args;
+        }
+        xstream_t stream(xcontext_t::instance(), (uint8_t*)action_param.data(), action_param.size());
+        uint8_t arg_num{0}, arg_type{0};
+        stream >> arg_num;
+        if (arg_num > MAX_ARG_NUM) {
+            throw xvm_error{enum_xvm_error_code::enum_lua_abi_input_error, "arg num " + std::to_string(arg_num) + " great than max number 16"};
+        }
+        while (arg_num--) {
+            xreg_value_t value;
+            stream >> arg_type;
+            switch (arg_type) {
+                case ARG_TYPE_INT64:
+                    stream >> value.i;
+                    break;
+                case ARG_TYPE_UINT64: {
+                    uint64_t arg_uint64{0};
+                    stream >> arg_uint64;
+                    value.i = static_cast<int64_t>(arg_uint64);
+                    break;
+                }
+                case ARG_TYPE_STRING:
+                    value.is_int = false;
+                    stream >> value.s;
+                    break;
+                case ARG_TYPE_BOOL: {
+                    bool arg_bool{false};
+                    stream >> arg_bool;
+                    value.i = arg_bool ? 1 : 0;
+                    break;
+                }
+                default:
+                    throw xvm_error{enum_xvm_error_code::enum_lua_abi_input_error, "param stream not valid"};
+            }
+            args.push_back(std::move(value));
+        }
+    } catch(const xvm_error& e) {
+        throw e;
+    } catch(enum_xerror_code& e) {
+        throw xvm_error{enum_xvm_error_code::enum_lua_abi_input_error, "action_param stream is not valid"};
+    } catch(...) {
+        throw xvm_error{enum_xvm_error_code::enum_lua_abi_input_error, "unkown exception"};
+    }
+    return args;
+}
+
+void xreg_engine::charge(uint64_t tgas) {
+    m_instruction_count += tgas;
+    if (m_tgas_limit != 0 && m_instruction_count > m_tgas_limit) {
+        throw xvm_error{enum_xvm_error_code::enum_lua_exec_tgas_limit_exceeded, "tgas limit " + std::to_string(m_tgas_limit) + " exceeded"};
+    }
+    if (m_instruction_count > XREG_INSTRUCTION_LIMIT) {
+        throw xvm_error{enum_xvm_error_code::enum_lua_exec_tgas_limit_exceeded, "instruction limit " + std::to_string(XREG_INSTRUCTION_LIMIT) + " exceeded"};
+    }
+}
+
+static int64_t int_of(const xreg_engine::xreg_value_t& value) {
+    if (!value.is_int) {
+        throw xvm_error{enum_xvm_error_code::enum_vm_exception, "integer expected"};
+    }
+    return value.i;
+}
+
+static const std::string& string_of(const xreg_engine::xreg_value_t& value) {
+    if (value.is_int) {
+        throw xvm_error{enum_xvm_error_code::enum_vm_exception, "string expected"};
+    }
+    return value.s;
+}
+
+static xreg_engine::xreg_value_t int_value(int64_t i) {
+    xreg_engine::xreg_value_t value;
+    value.i = i;
+    return value;
+}
+
+static xreg_engine::xreg_value_t string_value(std::string s) {
+    xreg_engine::xreg_value_t value;
+    value.is_int = false;
+    value.s = std::move(s);
+    return value;
+}
+
+// concat checks the size before building the string
+static xreg_engine::xreg_value_t concat_value(const std::string& lhs, const std::string& rhs, std::size_t memory_available) {
+    if (lhs.size() + rhs.size() > memory_available) {
+        throw xvm_error{enum_xvm_error_code::enum_lua_memory_limit_exceeded, "memory limit " + std::to_string(XREG_MEMORY_LIMIT) + " exceeded"};
+    }
+    return string_value(lhs + rhs);
+}
+
+void xreg_engine::assign(xreg_value_t& reg, xreg_value_t value) {
+    charge(value.s.size() / XREG_STRING_TGAS_BYTES);
+    auto memory_usage = m_memory_usage - reg.s.size() + value.s.size();
+    if (memory_usage > XREG_MEMORY_LIMIT) {
+        throw xvm_error{enum_xvm_error_code::enum_lua_memory_limit_exceeded, "memory limit " + std::to_string(XREG_MEMORY_LIMIT) + " exceeded"};
+    }
+    m_memory_usage = memory_usage;
+    reg = std::move(value);
+}
+
+static bool less_than(const xreg_engine::xreg_value_t& lhs, const xreg_engine::xreg_value_t& rhs) {
+    if (lhs.is_int != rhs.is_int) {
+        throw xvm_error{enum_xvm_error_code::enum_vm_exception, "compare integer with string"};
+    }
+    return lhs.is_int ? lhs.i < rhs.i : lhs.s < rhs.s;
+}
+
+void xreg_engine::run(const xreg_function_t& func, const std::vector<xreg_value_t>& args, xvm_context& ctx) {
+    xreg_value_t regs[XREG_REGISTER_NUM];
+    m_memory_usage = 0;
+    auto & helper = *ctx.m_contract_helper;
+    std::size_t pc{0};
+    while (pc < func.code.size()) {
+        auto const & ins = func.code[pc++];
+        charge(1);
+        auto & ra = regs[ins.a];
+        auto const & rb = regs[ins.b];
+        auto const & rc = regs[ins.c];
+        switch (ins.op) {
+            case enum_xreg_opcode::loadi:   assign(ra, int_value(ins.imm)); break;
+            case enum_xreg_opcode::loads:   assign(ra, string_value(m_constants[ins.konst])); break;
+            case enum_xreg_opcode::arg:     assign(ra, args[ins.imm]); break;
+            case enum_xreg_opcode::mov:     if (&ra != &rb) { assign(ra, rb); } break;
+            // wrap around on overflow like lua integers
+            case enum_xreg_opcode::add:     assign(ra, int_value(static_cast<int64_t>(static_cast<uint64_t>(int_of(rb)) + static_cast<uint64_t>(int_of(rc))))); break;
+            case enum_xreg_opcode::sub:     assign(ra, int_value(static_cast<int64_t>(static_cast<uint64_t>(int_of(rb)) - static_cast<uint64_t>(int_of(rc))))); break;
+            case enum_xreg_opcode::mul:     assign(ra, int_value(static_cast<int64_t>(static_cast<uint64_t>(int_of(rb)) * static_cast<uint64_t>(int_of(rc))))); break;
+            case enum_xreg_opcode::div:
+            case enum_xreg_opcode::mod: {
+                auto lhs = int_of(rb);
+                auto rhs = int_of(rc);
+                if (rhs == 0) {
+                    throw xvm_error{enum_xvm_error_code::enum_vm_exception, "divide by zero"};
+                }
+                if (rhs == -1) {
+                    assign(ra, int_value(ins.op == enum_xreg_opcode::div ? static_cast<int64_t>(0 - static_cast<uint64_t>(lhs)) : 0));
+                } else {
+                    assign(ra, int_value(ins.op == enum_xreg_opcode::div ? lhs / rhs : lhs % rhs));
+                }
+                break;
+            }
+            case enum_xreg_opcode::concat:  assign(ra, concat_value(string_of(rb), string_of(rc), XREG_MEMORY_LIMIT - m_memory_usage + ra.s.size())); break;
+            case enum_xreg_opcode::eq:      assign(ra, int_value(rb.is_int == rc.is_int && rb.i == rc.i && rb.s == rc.s)); break;
+            case enum_xreg_opcode::lt:      assign(ra, int_value(less_than(rb, rc))); break;
+            case enum_xreg_opcode::le:      assign(ra, int_value(!less_than(rc, rb))); break;
+            case enum_xreg_opcode::jmp:     pc = static_cast<std::size_t>(ins.imm); break;
+            case enum_xreg_opcode::jz:      if (int_of(ra) == 0) { pc = static_cast<std::size_t>(ins.imm); } break;
+            case enum_xreg_opcode::jnz:     if (int_of(ra) != 0) { pc = static_cast<std::size_t>(ins.imm); } break;
+            case enum_xreg_opcode::toint: {
+                if (rb.is_int) {
+                    assign(ra, int_value(rb.i));
+                } else {
+                    int64_t value{0};
+                    if (!parse_int(rb.s, value)) {
+                        throw xvm_error{enum_xvm_error_code::enum_vm_exception, "toint error:" + rb.s};
+                    }
+                    assign(ra, int_value(value));
+                }
+                break;
+            }
+            case enum_xreg_opcode::tostr:   assign(ra, string_value(rb.is_int ? std::to_string(rb.i) : rb.s)); break;
+            case enum_xreg_opcode::get:
+                charge(XREG_DB_OP_TGAS);
+                assign(ra, string_value(helper.string_get(string_of(rb))));
+                break;
+            case enum_xreg_opcode::set:
+                charge(XREG_DB_OP_TGAS);
+                helper.string_set(string_of(ra), string_of(rb));
+                break;
+            case enum_xreg_opcode::hget:
+                charge(XREG_DB_OP_TGAS);
+                assign(ra, string_value(helper.map_get(string_of(rb), string_of(rc))));
+                break;
+            case enum_xreg_opcode::hset:
+                charge(XREG_DB_OP_TGAS);
+                helper.map_set(string_of(ra), string_of(rb), string_of(rc));
+                break;
+            case enum_xreg_opcode::require:
+                if (int_of(ra) == 0) {
+                    throw xvm_error{enum_xvm_error_code::enum_vm_exception, "require failed:" + m_constants[ins.konst]};
+                }
+                break;
+            case enum_xreg_opcode::ret:
+                return;
+        }
+    }
+}
+
+void xreg_engine::load_script(const std::string& code, xvm_context& ctx) {
+    auto tgas_limit = ctx.m_contract_helper->string_get2(data::XPROPERTY_CONTRACT_TGAS_LIMIT_KEY);
+    m_tgas_limit = tgas_limit.empty() ? 0 : std::strtoull(tgas_limit.c_str(), nullptr, 10);
+    compile(code);
+}
+
+void xreg_engine::publish_script(const std::string& code, xvm_context& ctx) {
+    m_instruction_count = 0;
+    xtop_scope_executer on_exit([&ctx, this] {
+        ctx.m_trace_ptr->m_instruction_usage = static_cast<uint32_t>(this->m_instruction_count);
+    });
+    m_tgas_limit = ctx.m_tgas_limit;
+    compile(code);
+    auto iter = m_functions.find("init");
+    if (iter != m_functions.end()) {
+        if (iter->second.arg_num != 0) {
+            throw xvm_error{enum_xvm_error_code::enum_vm_code_parse_error, "init can't have args"};
+        }
+        run(iter->second, {}, ctx);
+    }
+}
+
+void xreg_engine::process(common::xaccount_address_t const & contract_account, const std::string& code, xvm_context& ctx) {
+    m_instruction_count = 0;
+    xtop_scope_executer on_exit([&ctx, this] {
+        ctx.m_trace_ptr->m_instruction_usage = static_cast<uint32_t>(this->m_instruction_count);
+        ctx.m_contract_helper->get_gas_and_disk_usage(ctx.m_trace_ptr->m_tgas_usage, ctx.m_trace_ptr->m_disk_usage);
+    });
+    auto const & action_name = ctx.m_current_action.get_action_name();
+    if (action_name == "init") {
+        throw xvm_error{enum_xvm_error_code::enum_lua_abi_input_error, "can't call init function"};
+    }
+    auto iter = m_functions.find(action_name);
+    if (iter == m_functions.end()) {
+        throw xvm_error{enum_xvm_error_code::enum_vm_no_func_find, "action " + action_name + " not found"};
+    }
+    auto args = arg_parse(ctx.m_current_action.get_action_param());
+    if (args.size() != iter->second.arg_num) {
+        throw xvm_error{enum_xvm_error_code::enum_lua_abi_input_error, "arg num " + std::to_string(args.size()) + " not match " + std::to_string(iter->second.arg_num)};
+    }
+    run(iter->second, args, ctx);
+}
+
+std::size_t xreg_engine::memory_usage() const {
+    std::size_t usage{0};
+    for (auto const & func : m_functions) {
+        usage += func.first.size() + func.second.code.capacity() * sizeof(xreg_instruction_t);
+    }
+    for (auto const & konst : m_constants) {
+        usage += konst.capacity();
+    }
+    return usage;
+}
+
+NS_END2
@@ -0,0 +1,90 @@
+// Copyright (c) 2017-2018 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+#include <string>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "xvm/xvm_engine.h"
+#include "xvm/xvm_define.h"
+NS_BEG2(top, xvm)
+#define XREG_ENGINE_HEADER      "#!xrvm\n"
+#define XREG_REGISTER_NUM       16
+#define XREG_DB_OP_TGAS         50      // same as DB_OP_INSTRUCTION_COUNT of the lua api
+#define XREG_STRING_TGAS_BYTES  64      // a string result costs one more tgas per XREG_STRING_TGAS_BYTES bytes
+#define XREG_MEMORY_LIMIT       (16 * 1024 * 1024)  // bytes the registers may hold, same as LUA_MEMORY_LIMIT_DEFAULT
+#define XREG_INSTRUCTION_LIMIT  (100 * 1000 * 1000) // hard cap of one execution, also when the contract has no tgas limit
+
+/**
+ * @brief register based interpreter for a restricted contract subset. the code is text
+ *        assembly starting with XREG_ENGINE_HEADER:
+ *
+ *        action transfer 2         ; exported action and its arg num
+ *            arg     r0 0
+ *            get     r1 r0
+ *            ...
+ *            ret
+ *        end
+ *
+ *        values are int64 or string, one instruction costs one tgas, property ops
+ *        cost XREG_DB_OP_TGAS more and string results cost by length. the registers
+ *        hold at most XREG_MEMORY_LIMIT bytes and one execution runs at most
+ *        XREG_INSTRUCTION_LIMIT instructions. the optional "init" action runs when published
+ *
+ */
+class xreg_engine : public xengine
+{
+public:
+    void load_script(const std::string& code, xvm_context& ctx) override;
+    void publish_script(const std::string& code, xvm_context& ctx) override;
+    void process(common::xaccount_address_t const & contract_account, const std::string& code, xvm_context& ctx) override;
+    std::size_t memory_usage() const override;
+
+public:
+    enum class enum_xreg_opcode : uint8_t {
+        loadi, loads, arg, mov,
+        add, sub, mul, div, mod, concat,
+        eq, lt, le,
+        jmp, jz, jnz,
+        toint, tostr,
+        get, set, hget, hset,
+        require, ret,
+    };
+
+    struct xreg_instruction_t {
+        enum_xreg_opcode    op;
+        uint8_t             a{0};
+        uint8_t             b{0};
+        uint8_t             c{0};
+        int64_t             imm{0};     // integer operand or jump target
+        uint32_t            konst{0};   // index of the string constant
+    };
+
+    struct xreg_function_t {
+        uint8_t                             arg_num{0};
+        std::vector<xreg_instruction_t>     code;
+    };
+
+    struct xreg_value_t {
+        bool            is_int{true};
+        int64_t         i{0};
+        std::string     s;
+    };
+
+private:
+    void compile(const std::string& code);
+    std::vector<xreg_value_t> arg_parse(const std::string& action_param);
+    void run(const xreg_function_t& func, const std::vector<xreg_value_t>& args, xvm_context& ctx);
+    void charge(uint64_t tgas);
+    void assign(xreg_value_t& reg, xreg_value_t value);
+
+private:
+    std::unordered_map<std::string, xreg_function_t>    m_functions;
+    std::vector<std::string>                            m_constants;
+    uint64_t                                            m_tgas_limit{0};    // 0 means no limit
+    uint64_t                                            m_instruction_count{0};
+    std::size_t                                         m_memory_usage{0};  // bytes of the strings in the registers
+};
+NS_END2
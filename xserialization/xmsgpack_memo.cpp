@@ -0,0 +1,83 @@
+// Copyright (c) 2017-2018 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "xvm/xserialization/xmsgpack_memo.h"
+
+#include "xmetrics/xmetrics.h"
+#include "xutility/xhash.h"
+
+NS_BEG3(top, xvm, serialization)
+
+std::atomic<bool> xtop_msgpack_memo::s_enabled{false};
+
+xtop_msgpack_memo & xtop_msgpack_memo::instance() {
+    static xtop_msgpack_memo * inst = new xtop_msgpack_memo();
+    return *inst;
+}
+
+uint64_t xtop_msgpack_memo::key_of(std::type_index type, std::string const & content) {
+    return utl::xxh64_t::digest(content.data(), content.size()) ^ static_cast<uint64_t>(type.hash_code());
+}
+
+std::size_t xtop_msgpack_memo::size_of(std::string const & content) {
+    return sizeof(xentry_t) + content.size() + content.size() * XMSGPACK_MEMO_DECODED_FACTOR;
+}
+
+void xtop_msgpack_memo::set_budget(std::size_t bytes) {
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_budget = bytes;
+    evict();
+}
+
+std::shared_ptr<void const> xtop_msgpack_memo::get(std::type_index type, std::string const & content, uint64_t & decode_us) {
+    std::lock_guard<std::mutex> lock(m_lock);
+    auto iter = m_index.find(key_of(type, content));
+    // the content is compared too, a hash collision must not return another object
+    if (iter == m_index.end() || iter->second->type != type || iter->second->content != content) {
+        XMETRICS_COUNTER_INCREMENT("xvm_msgpack_memo_miss", 1);
+        return nullptr;
+    }
+    m_lru.splice(m_lru.begin(), m_lru, iter->second);
+    XMETRICS_COUNTER_INCREMENT("xvm_msgpack_memo_hit", 1);
+    decode_us = iter->second->decode_us;
+    return iter->second->object;
+}
+
+void xtop_msgpack_memo::put(std::type_index type, std::string const & content, std::shared_ptr<void const> object, uint64_t decode_us) {
+    std::lock_guard<std::mutex> lock(m_lock);
+    auto size = size_of(content);
+    if (size > m_budget) {
+        return;
+    }
+    auto key = key_of(type, content);
+    auto iter = m_index.find(key);
+    if (iter != m_index.end()) {
+        m_size -= iter->second->size;
+        m_lru.erase(iter->second);
+        m_index.erase(iter);
+    }
+    m_lru.push_front(xentry_t{key, type, content, std::move(object), decode_us, size});
+    m_index[key] = m_lru.begin();
+    m_size += size;
+    evict();
+}
+
+void xtop_msgpack_memo::evict() {
+    while (m_size > m_budget && !m_lru.empty()) {
+        auto & entry = m_lru.back();
+        m_size -= entry.size;
+        m_index.erase(entry.key);
+        m_lru.pop_back();
+        XMETRICS_COUNTER_INCREMENT("xvm_msgpack_memo_evict", 1);
+    }
+}
+
+void xtop_msgpack_memo::clear() {
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_lru.clear();
+    m_index.clear();
+    m_size = 0;
+}
+
+NS_END3
@@ -0,0 +1,86 @@
+// Copyright (c) 2017-2018 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include "xbasic/xns_macro.h"
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+
+NS_BEG3(top, xvm, serialization)
+
+#define XMSGPACK_MEMO_DEFAULT_BUDGET    (64 * 1024 * 1024)
+#define XMSGPACK_MEMO_BUDGET_CONFIG     "xvm_msgpack_memo_budget"   // config of the memo budget in bytes, the memo is enabled if > 0
+#define XMSGPACK_MEMO_DECODED_FACTOR    4   // decoded containers take about this many times their msgpack bytes
+
+/**
+ * @brief opt-in memo of the objects decoded from msgpack properties, keyed by the decoded
+ *        type and the content of the property. the decoded objects are shared and immutable,
+ *        the least recently used are evicted once the estimated bytes kept exceed the budget
+ *
+ */
+class xtop_msgpack_memo {
+public:
+    static xtop_msgpack_memo & instance();
+
+    static bool enabled() noexcept { return s_enabled.load(std::memory_order_relaxed); }
+    void set_enabled(bool enabled) noexcept { s_enabled.store(enabled, std::memory_order_relaxed); }
+
+    /**
+     * @brief Set the memory budget, evicts at once if over it
+     *
+     * @param bytes  the max bytes kept, counting the property contents and the estimated decoded objects
+     */
+    void set_budget(std::size_t bytes);
+
+    /**
+     * @brief get the object decoded from the content
+     *
+     * @param type  the decoded type
+     * @param content  the property content
+     * @param decode_us  the time the decode took, i.e. the time saved by the hit
+     * @return std::shared_ptr<void const>  nullptr if not memoized
+     */
+    std::shared_ptr<void const> get(std::type_index type, std::string const & content, uint64_t & decode_us);
+
+    void put(std::type_index type, std::string const & content, std::shared_ptr<void const> object, uint64_t decode_us);
+
+    void clear();
+
+private:
+    xtop_msgpack_memo() = default;
+
+    struct xentry_t {
+        uint64_t                    key;
+        std::type_index             type;
+        std::string                 content;
+        std::shared_ptr<void const> object;
+        uint64_t                    decode_us;
+        std::size_t                 size;       // the bytes charged to the budget
+    };
+
+    static uint64_t key_of(std::type_index type, std::string const & content);
+    // the content kept as the key, plus the estimated size of the object decoded from it
+    static std::size_t size_of(std::string const & content);
+    void evict();
+
+private:
+    static std::atomic<bool>                                        s_enabled;
+    std::mutex                                                      m_lock;
+    std::size_t                                                     m_budget{XMSGPACK_MEMO_DEFAULT_BUDGET};
+    std::size_t                                                     m_size{0};
+    std::list<xentry_t>                                             m_lru;      // most recently used first
+    std::unordered_map<uint64_t, std::list<xentry_t>::iterator>     m_index;
+};
+
+using xmsgpack_memo_t = xtop_msgpack_memo;
+
+NS_END3
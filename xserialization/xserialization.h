@@ -9,8 +9,12 @@
 #include "xdata/xnative_contract_address.h"
 #include "xvm/xcontract/xcontract_base.h"
 #include "xvm/xerror/xvm_error.h"
+#include "xvm/xserialization/xmsgpack_memo.h"
 
+#include <chrono>
+#include <memory>
 #include <string>
+#include <typeindex>
 
 NS_BEG3(top, xvm, serialization)
 
@@ -32,7 +36,7 @@ struct xtop_msgpack final {
                 return T{};
             } else {
                 XMETRICS_COUNTER_INCREMENT(sys_addr_to_metrics_enum_get_property_size.at(contract.SELF_ADDRESS()), string_value.size());
-                return codec::msgpack_decode<T>({ std::begin(string_value), std::end(string_value) });
+                return decode(contract, string_value);
             }
         } catch (xvm::xvm_error const & eh) {
             xwarn("[xvm] deserialize %s failed: %s", property_name.c_str(), eh.what());
@@ -53,7 +57,52 @@ struct xtop_msgpack final {
                 return T{};
             } else {
                 XMETRICS_COUNTER_INCREMENT(sys_addr_to_metrics_enum_get_property_size.at(contract.SELF_ADDRESS()), string_value.size());
-                return codec::msgpack_decode<T>({ std::begin(string_value), std::end(string_value) });
+                return decode(contract, string_value);
+            }
+        } catch (xvm::xvm_error const & eh) {
+            xwarn("[xvm] deserialize %s failed: %s", property_name.c_str(), eh.what());
+            throw;
+        }
+    }
+
+    /**
+     * @brief like deserialize_from_string_prop, but shares the decoded object instead of
+     *        copying it out of the memo, for the callers only reading it
+     *
+     */
+    static
+    std::shared_ptr<T const>
+    deserialize_shared_from_string_prop(xcontract::xcontract_base const & contract, std::string const & property_name) {
+        assert(sys_addr_to_metrics_enum_get_property_time.find(contract.SELF_ADDRESS()) != std::end(sys_addr_to_metrics_enum_get_property_time));
+        XMETRICS_TIME_RECORD(xvm::serialization::sys_addr_to_metrics_enum_get_property_time.at(contract.SELF_ADDRESS()));
+        try {
+            auto string_value = contract.STRING_GET(property_name);
+            if (string_value.empty()) {
+                return std::make_shared<T const>();
+            } else {
+                XMETRICS_COUNTER_INCREMENT(sys_addr_to_metrics_enum_get_property_size.at(contract.SELF_ADDRESS()), string_value.size());
+                return decode_shared(contract, string_value);
+            }
+        } catch (xvm::xvm_error const & eh) {
+            xwarn("[xvm] deserialize %s failed: %s", property_name.c_str(), eh.what());
+            throw;
+        }
+    }
+
+    static
+    std::shared_ptr<T const>
+    deserialize_shared_from_string_prop(xcontract::xcontract_base const & contract,
+                                        std::string const & another_contract_address,
+                                        std::string const & property_name) {
+        assert(sys_addr_to_metrics_enum_get_property_time.find(contract.SELF_ADDRESS()) != std::end(sys_addr_to_metrics_enum_get_property_time));
+        XMETRICS_TIME_RECORD(sys_addr_to_metrics_enum_get_property_time.at(contract.SELF_ADDRESS()));
+        try {
+            auto string_value = contract.QUERY(xcontract::enum_type_t::string, property_name, "", another_contract_address);
+            if (string_value.empty()) {
+                return std::make_shared<T const>();
+            } else {
+                XMETRICS_COUNTER_INCREMENT(sys_addr_to_metrics_enum_get_property_size.at(contract.SELF_ADDRESS()), string_value.size());
+                return decode_shared(contract, string_value);
             }
         } catch (xvm::xvm_error const & eh) {
             xwarn("[xvm] deserialize %s failed: %s", property_name.c_str(), eh.what());
@@ -90,6 +139,66 @@ struct xtop_msgpack final {
     deserialize_from_string_prop(std::string const & property_value) {
         return codec::msgpack_decode<T>({ std::begin(property_value), std::end(property_value) });
     }
+
+private:
+    static
+    T
+    decode(xcontract::xcontract_base const & contract, std::string const & string_value) {
+        if (!xmsgpack_memo_t::enabled()) {
+            return codec::msgpack_decode<T>({ std::begin(string_value), std::end(string_value) });
+        }
+
+        uint64_t decode_us{0};
+        auto memoized = memo_get(string_value, decode_us);
+        if (memoized == nullptr) {
+            return *memo_decode(string_value);
+        }
+        // the caller gets its own copy, only the decode time beyond the copy is saved
+        auto start = std::chrono::steady_clock::now();
+        T object = *memoized;
+        auto copy_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+        record_saved(contract, decode_us > copy_us ? decode_us - copy_us : 0);
+        return object;
+    }
+
+    static
+    std::shared_ptr<T const>
+    decode_shared(xcontract::xcontract_base const & contract, std::string const & string_value) {
+        if (!xmsgpack_memo_t::enabled()) {
+            return std::make_shared<T const>(codec::msgpack_decode<T>({ std::begin(string_value), std::end(string_value) }));
+        }
+
+        uint64_t decode_us{0};
+        auto memoized = memo_get(string_value, decode_us);
+        if (memoized == nullptr) {
+            return memo_decode(string_value);
+        }
+        record_saved(contract, decode_us);
+        return memoized;
+    }
+
+    static
+    std::shared_ptr<T const>
+    memo_get(std::string const & string_value, uint64_t & decode_us) {
+        return std::static_pointer_cast<T const>(xmsgpack_memo_t::instance().get(std::type_index{typeid(T)}, string_value, decode_us));
+    }
+
+    static
+    std::shared_ptr<T const>
+    memo_decode(std::string const & string_value) {
+        auto start = std::chrono::steady_clock::now();
+        auto object = std::make_shared<T const>(codec::msgpack_decode<T>({ std::begin(string_value), std::end(string_value) }));
+        auto decode_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+        xmsgpack_memo_t::instance().put(std::type_index{typeid(T)}, string_value, object, decode_us);
+        return object;
+    }
+
+    static
+    void
+    record_saved(xcontract::xcontract_base const & contract, uint64_t saved_us) {
+        std::string const saved_metrics = sys_addr_to_metrics_enum_get_property_time.at(contract.SELF_ADDRESS()) + "_memo_saved_us";
+        XMETRICS_COUNTER_INCREMENT(saved_metrics, saved_us);
+    }
 };
 
 template <typename T>
@@ -431,13 +431,8 @@ void xrec_registration_contract::updateNodeSignKey(const std::string & node_sign
 // }
 
 void xrec_registration_contract::update_node_info(xreg_node_info & node_info) {
-    base::xstream_t stream(base::xcontext_t::instance());
-    node_info.serialize_to(stream);
-
-    std::string stream_str = std::string((char *)stream.data(), stream.size());
-
-    XMETRICS_TIME_RECORD(XREG_CONTRACT "XPORPERTY_CONTRACT_REG_KEY_SetExecutionTime");
-    MAP_SET(XPORPERTY_CONTRACT_REG_KEY, node_info.m_account, stream_str);
+    // encoded once at the end of the execution, however many times the node is updated
+    PROPERTY<xreg_node_info>(XPORPERTY_CONTRACT_REG_KEY, node_info.m_account).mutate() = node_info;
 }
 
 void xrec_registration_contract::delete_node_info(std::string const & account) {
@@ -448,21 +443,16 @@ void xrec_registration_contract::delete_node_info(std::string const & account) {
 int32_t xrec_registration_contract::get_node_info(const std::string & account, xreg_node_info & node_info) {
     // xdbg("[xrec_registration_contract] get_node_info account(%s) pid:%d\n", account.c_str(), getpid());
 
-    std::string value_str;
+    auto node = PROPERTY<xreg_node_info>(XPORPERTY_CONTRACT_REG_KEY, account);
     {
         XMETRICS_TIME_RECORD(XREG_CONTRACT "XPORPERTY_CONTRACT_REG_KEY_GetExecutionTime");
-        MAP_GET2(XPORPERTY_CONTRACT_REG_KEY, account, value_str);
-    }
-
-    if (value_str.empty()) {
-        xdbg("[xrec_registration_contract] account(%s) not exist pid:%d\n", account.c_str(), getpid());
-        return xaccount_property_not_exist;
+        if (!node.exist()) {
+            xdbg("[xrec_registration_contract] account(%s) not exist pid:%d\n", account.c_str(), getpid());
+            return xaccount_property_not_exist;
+        }
     }
 
-    base::xstream_t stream(base::xcontext_t::instance(), (uint8_t *)value_str.c_str(), (uint32_t)value_str.size());
-
-    node_info.serialize_from(stream);
-
+    node_info = node.get();
     return 0;
 }
 
@@ -724,21 +714,14 @@ void xrec_registration_contract::update_batch_stake_v2(uint64_t report_time, std
 }
 
 void xrec_registration_contract::check_and_set_genesis_stage() {
-    std::string value_str;
-    xactivation_record record;
-
+    auto genesis_stage = PROPERTY<xactivation_record>(XPORPERTY_CONTRACT_GENESIS_STAGE_KEY);
     {
         XMETRICS_TIME_RECORD(XREG_CONTRACT "XPORPERTY_CONTRACT_GENESIS_STAGE_KEY_GetExecutionTime");
-        value_str = STRING_GET(XPORPERTY_CONTRACT_GENESIS_STAGE_KEY);
-    }
-
-    if (!value_str.empty()) {
-        base::xstream_t stream(base::xcontext_t::instance(), (uint8_t *)value_str.c_str(), (uint32_t)value_str.size());
-        record.serialize_from(stream);
-    }
-    if (record.activated) {
-        xinfo("[xrec_registration_contract::check_and_set_genesis_stage] activated: %d, activation_time: %llu, pid:%d\n", record.activated, record.activation_time, getpid());
-        return;
+        auto const & record = genesis_stage.get();
+        if (record.activated) {
+            xinfo("[xrec_registration_contract::check_and_set_genesis_stage] activated: %d, activation_time: %llu, pid:%d\n", record.activated, record.activation_time, getpid());
+            return;
+        }
     }
 
     std::map<std::string, std::string> map_nodes;
@@ -749,17 +732,11 @@ void xrec_registration_contract::check_and_set_genesis_stage() {
         xdbg("[xrec_registration_contract::check_and_set_genesis_stage] MAP COPY GET error:%s", e.what());
     }
     bool active = check_registered_nodes_active(map_nodes);
+    // written back even if not activated, as it always was
+    auto & new_record = genesis_stage.mutate();
     if (active) {
-        record.activated = 1;
-        record.activation_time = TIME();
-    }
-
-    base::xstream_t stream(base::xcontext_t::instance());
-    record.serialize_to(stream);
-    value_str = std::string((char *)stream.data(), stream.size());
-    {
-        XMETRICS_TIME_RECORD(XREG_CONTRACT "XPORPERTY_CONTRACT_GENESIS_STAGE_KEY_SetExecutionTime");
-        STRING_SET(XPORPERTY_CONTRACT_GENESIS_STAGE_KEY, value_str);
+        new_record.activated = 1;
+        new_record.activation_time = TIME();
     }
 }
 
@@ -251,12 +251,8 @@ bool xtop_rec_standby_pool_contract::update_activated_state(xstandby_network_sto
     if (standby_network_storage_result.activated_state()) {
         return false;
     }
-    xstake::xactivation_record record;
-    std::string value_str = STRING_GET2(xstake::XPORPERTY_CONTRACT_GENESIS_STAGE_KEY, sys_contract_rec_registration_addr);
-    if (!value_str.empty()) {
-        base::xstream_t stream(base::xcontext_t::instance(), (uint8_t *)value_str.c_str(), (uint32_t)value_str.size());
-        record.serialize_from(stream);
-    }
+    // decoded once for all the networks
+    auto const & record = PROPERTY<xstake::xactivation_record>(xstake::XPORPERTY_CONTRACT_GENESIS_STAGE_KEY, "", sys_contract_rec_registration_addr).get();
     if (record.activated) {
         standby_network_storage_result.set_activate_state(true);
         return true;
@@ -271,19 +267,16 @@ void xtop_rec_standby_pool_contract::on_timer(common::xlogic_time_t const curren
     XCONTRACT_ENSURE(SELF_ADDRESS().value() == sys_contract_rec_standby_pool_addr, u8"xrec_standby_pool_contract_t instance is not triggled by xrec_standby_pool_contract_t");
     XCONTRACT_ENSURE(current_time <= TIME(), u8"xrec_standby_pool_contract_t::on_timer current_time > consensus leader's time");
 
-    std::map<std::string, std::string> reg_node_info;  // key is the account string, value is the serialized data
-    MAP_COPY_GET(xstake::XPORPERTY_CONTRACT_REG_KEY, reg_node_info, sys_contract_rec_registration_addr);
-    xdbg("[xrec_standby_pool_contract_t][on_timer] registration data size %zu", reg_node_info.size());
-
+    // key is the account string, value is the serialized data
     std::map<common::xnode_id_t, xstake::xreg_node_info> registration_data;
-    for (auto const & item : reg_node_info) {
-        xstake::xreg_node_info node_info;
-        base::xstream_t stream(base::xcontext_t::instance(), (uint8_t *)item.second.c_str(), (uint32_t)item.second.size());
+    MAP_FOR_EACH(xstake::XPORPERTY_CONTRACT_REG_KEY, [&](const std::string & account, const std::string & value) {
+        base::xstream_t stream(base::xcontext_t::instance(), (uint8_t *)value.c_str(), (uint32_t)value.size());
 
-        node_info.serialize_from(stream);
-        registration_data[common::xnode_id_t{item.first}] = node_info;
-        xdbg("[xrec_standby_pool_contract_t][on_timer] found from registration contract node %s", item.first.c_str());
-    }
+        registration_data[common::xnode_id_t{account}].serialize_from(stream);
+        xdbg("[xrec_standby_pool_contract_t][on_timer] found from registration contract node %s", account.c_str());
+        return true;
+    }, sys_contract_rec_registration_addr);
+    xdbg("[xrec_standby_pool_contract_t][on_timer] registration data size %zu", registration_data.size());
     XCONTRACT_ENSURE(!registration_data.empty(), "read registration data failed");
 
     bool updated{false};
@@ -281,8 +281,9 @@ void xtop_zec_elect_consensus_group_contract::elect(common::xzone_id_t const zon
         return;
     }
 
-    auto const & election_association_result_store = serialization::xmsgpack_t<xelection_association_result_store_t>::deserialize_from_string_prop(
+    auto const election_association_result_store_ptr = serialization::xmsgpack_t<xelection_association_result_store_t>::deserialize_shared_from_string_prop(
         *this, sys_contract_zec_group_assoc_addr, data::XPROPERTY_CONTRACT_GROUP_ASSOC_KEY);
+    auto const & election_association_result_store = *election_association_result_store_ptr;
     if (election_association_result_store.empty()) {
         xerror("[zec contract][elect_non_genesis] no association info");
         return;
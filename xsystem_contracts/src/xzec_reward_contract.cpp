@@ -375,22 +375,16 @@ void xzec_reward_contract::calc_nodes_rewards(std::map<std::string, std::map<std
     stream >> validator_workload;
     if (!validator_workload)  MAP_DESERIALIZE_SIMPLE(stream, validator_clusters_workloads);
 
-    // contract auditor votes
-    std::map<std::string, std::string> contract_auditor_votes2;
-    MAP_COPY_GET(XPORPERTY_CONTRACT_TICKETS_KEY, contract_auditor_votes2, sys_contract_zec_vote_addr);
-
-    xdbg("[xzec_reward_contract::calc_vote_rewards] contract_auditor_votes2 size: %d", contract_auditor_votes2.size());
-    // transform to map of map struct
+    // contract auditor votes, transform to map of map struct
     std::map<std::string, std::map<std::string, std::string>> contract_auditor_votes;
-    for (auto & contract_auditor_vote : contract_auditor_votes2) {
-        auto const & contract = contract_auditor_vote.first;
-        auto const & auditor_votes_str = contract_auditor_vote.second;
-
-        std::map<std::string, std::string> auditor_votes;
+    MAP_FOR_EACH(XPORPERTY_CONTRACT_TICKETS_KEY, [&](const std::string & contract, const std::string & auditor_votes_str) {
+        auto & auditor_votes = contract_auditor_votes[contract];
         xstream_t stream(xcontext_t::instance(), (uint8_t *)auditor_votes_str.data(), auditor_votes_str.size());
         stream >> auditor_votes;
-        contract_auditor_votes[contract] = auditor_votes;
-    }
+        return true;
+    }, sys_contract_zec_vote_addr);
+
+    xdbg("[xzec_reward_contract::calc_vote_rewards] contract_auditor_votes size: %d", contract_auditor_votes.size());
 
     // archive rewards / edge rewards
     std::map<std::string, std::string> map_nodes;
@@ -858,22 +852,16 @@ void xzec_reward_contract::calc_nodes_rewards_v2(std::map<std::string, std::map<
     MAP_DESERIALIZE_SIMPLE(stream, auditor_clusters_workloads);
     MAP_DESERIALIZE_SIMPLE(stream, validator_clusters_workloads);
 
-    // contract auditor votes
-    std::map<std::string, std::string> contract_auditor_votes2;
-    MAP_COPY_GET(XPORPERTY_CONTRACT_TICKETS_KEY, contract_auditor_votes2, sys_contract_zec_vote_addr);
-
-    xdbg("[xzec_reward_contract::calc_nodes_rewards_v2] contract_auditor_votes2 size: %d", contract_auditor_votes2.size());
-    // transform to map of map struct
+    // contract auditor votes, transform to map of map struct
     std::map<std::string, std::map<std::string, std::string>> contract_auditor_votes;
-    for (auto & contract_auditor_vote : contract_auditor_votes2) {
-        auto const & contract = contract_auditor_vote.first;
-        auto const & auditor_votes_str = contract_auditor_vote.second;
-
-        std::map<std::string, std::string> auditor_votes;
+    MAP_FOR_EACH(XPORPERTY_CONTRACT_TICKETS_KEY, [&](const std::string & contract, const std::string & auditor_votes_str) {
+        auto & auditor_votes = contract_auditor_votes[contract];
         xstream_t stream(xcontext_t::instance(), (uint8_t *)auditor_votes_str.data(), auditor_votes_str.size());
         stream >> auditor_votes;
-        contract_auditor_votes[contract] = auditor_votes;
-    }
+        return true;
+    }, sys_contract_zec_vote_addr);
+
+    xdbg("[xzec_reward_contract::calc_nodes_rewards_v2] contract_auditor_votes size: %d", contract_auditor_votes.size());
 
     uint64_t cur_time = onchain_timer_round;
     uint64_t activation_time = get_activated_time();
@@ -1356,22 +1344,16 @@ void xzec_reward_contract::calc_nodes_rewards_v3(std::map<std::string, std::map<
         xdbg("[xzec_reward_contract::calc_nodes_rewards_v3] clear_workload error: %s", e.what());
     }
 
-    // contract auditor votes
-    std::map<std::string, std::string> contract_auditor_votes2;
-    MAP_COPY_GET(XPORPERTY_CONTRACT_TICKETS_KEY, contract_auditor_votes2, sys_contract_zec_vote_addr);
-
-    xdbg("[xzec_reward_contract::calc_nodes_rewards_v3] contract_auditor_votes2 size: %d", contract_auditor_votes2.size());
-    // transform to map of map struct
+    // contract auditor votes, transform to map of map struct
     std::map<std::string, std::map<std::string, std::string>> contract_auditor_votes;
-    for (auto & contract_auditor_vote : contract_auditor_votes2) {
-        auto const & contract = contract_auditor_vote.first;
-        auto const & auditor_votes_str = contract_auditor_vote.second;
-
-        std::map<std::string, std::string> auditor_votes;
+    MAP_FOR_EACH(XPORPERTY_CONTRACT_TICKETS_KEY, [&](const std::string & contract, const std::string & auditor_votes_str) {
+        auto & auditor_votes = contract_auditor_votes[contract];
         xstream_t stream(xcontext_t::instance(), (uint8_t *)auditor_votes_str.data(), auditor_votes_str.size());
         stream >> auditor_votes;
-        contract_auditor_votes[contract] = auditor_votes;
-    }
+        return true;
+    }, sys_contract_zec_vote_addr);
+
+    xdbg("[xzec_reward_contract::calc_nodes_rewards_v3] contract_auditor_votes size: %d", contract_auditor_votes.size());
 
     uint64_t cur_time = onchain_timer_round;
     uint64_t activation_time = get_activated_time();
@@ -1853,22 +1835,16 @@ void xzec_reward_contract::calc_nodes_rewards_v4(std::map<std::string, std::map<
         xdbg("[xzec_reward_contract::calc_nodes_rewards_v4] clear_workload error: %s", e.what());
     }
 
-    // contract auditor votes
-    std::map<std::string, std::string> contract_auditor_votes2;
-    MAP_COPY_GET(XPORPERTY_CONTRACT_TICKETS_KEY, contract_auditor_votes2, sys_contract_zec_vote_addr);
-
-    xdbg("[xzec_reward_contract::calc_nodes_rewards_v4] contract_auditor_votes2 size: %d", contract_auditor_votes2.size());
-    // transform to map of map struct
+    // contract auditor votes, transform to map of map struct
     std::map<std::string, std::map<std::string, std::string>> contract_auditor_votes;
-    for (auto & contract_auditor_vote : contract_auditor_votes2) {
-        auto const & contract = contract_auditor_vote.first;
-        auto const & auditor_votes_str = contract_auditor_vote.second;
-
-        std::map<std::string, std::string> auditor_votes;
+    MAP_FOR_EACH(XPORPERTY_CONTRACT_TICKETS_KEY, [&](const std::string & contract, const std::string & auditor_votes_str) {
+        auto & auditor_votes = contract_auditor_votes[contract];
         xstream_t stream(xcontext_t::instance(), (uint8_t *)auditor_votes_str.data(), auditor_votes_str.size());
         stream >> auditor_votes;
-        contract_auditor_votes[contract] = auditor_votes;
-    }
+        return true;
+    }, sys_contract_zec_vote_addr);
+
+    xdbg("[xzec_reward_contract::calc_nodes_rewards_v4] contract_auditor_votes size: %d", contract_auditor_votes.size());
 
     uint64_t cur_time = onchain_timer_round;
     uint64_t activation_time = get_activated_time();
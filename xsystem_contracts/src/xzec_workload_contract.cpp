@@ -41,14 +41,7 @@ void xzec_workload_contract::setup() {
 }
 
 int xzec_workload_contract::is_mainnet_activated() {
-    xactivation_record record;
-
-    std::string value_str = STRING_GET2(xstake::XPORPERTY_CONTRACT_GENESIS_STAGE_KEY, sys_contract_rec_registration_addr);
-    if (!value_str.empty()) {
-        base::xstream_t stream(base::xcontext_t::instance(),
-                    (uint8_t*)value_str.c_str(), (uint32_t)value_str.size());
-        record.serialize_from(stream);
-    }
+    auto const & record = PROPERTY<xactivation_record>(xstake::XPORPERTY_CONTRACT_GENESIS_STAGE_KEY, "", sys_contract_rec_registration_addr).get();
     xdbg("[xzec_workload_contract::is_mainnet_activated] activated: %d, pid:%d\n", record.activated, getpid());
     return record.activated;
 };
@@ -5,7 +5,10 @@
 #include "xbase/xmem.h"
 #include "xbase/xcontext.h"
 #include "xerror/xvm_error.h"
+#include "xbasic/xscope_executer.h"
 #include "xdata/xproperty.h"
+#include "xvm/xvm_engine_registry.h"
+#include "xvm/xcontract/xcontract_pool.h"
 #include "xvm/xcontract/xcontract_register.h"
 #include "xvm/manager/xcontract_manager.h"
 
@@ -35,10 +38,13 @@ void xvm_context::exec()
     //todo check white and black contract and action list
     auto native_contract = contract::xcontract_manager_t::instance().get_contract(m_contract_account);
     if (native_contract) {
-        // due to contract now is NOT non-state, just clone for every calling
-        std::unique_ptr<xcontract::xcontract_base> _contract{native_contract->clone()};
+        // due to contract now is NOT non-state, run a clone, reused by the thread once reset
+        auto _contract = xcontract::xcontract_pool::take(native_contract);
         assert(_contract != nullptr);
         if (_contract != nullptr) {
+            xtop_scope_executer put_back([native_contract, &_contract] {
+                xcontract::xcontract_pool::put(native_contract, std::move(_contract));
+            });
             _contract->exec(this);
         } else {
             xwarn("[xvm_context::exec] clone contract instance failed");
@@ -54,15 +60,18 @@ void xvm_context::exec()
         return;
     }
 
-    //check the cache vm is exist
+    //check the cache vm is exist, the engine is owned by this context until it is put back
     shared_ptr<xengine> engine;
     string code;
-    if (!m_vm_service.m_vm_cache.get(m_contract_account, engine)) {
-        engine = std::make_shared<xlua_engine>();
+    if (!m_vm_service.m_vm_cache.take(m_contract_account, engine)) {
+        m_trace_ptr->m_cold_start = true;
         m_contract_helper->get_contract_code(code);
+        engine = xvm_engine_registry::instance().create(code);
         engine->load_script(code, *this);
-        m_vm_service.m_vm_cache.put(m_contract_account, engine);
     }
+    xtop_scope_executer put_back([this, &engine] {
+        m_vm_service.m_vm_cache.put(m_contract_account, engine);
+    });
     std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
     engine->process(m_contract_account, code, *this);
     m_trace_ptr->m_duration_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
@@ -79,13 +88,24 @@ void xvm_context::publish_code()
         xstream_t stream(xcontext_t::instance(), (uint8_t*)m_current_action.get_action_param().data(), m_current_action.get_action_param().size());
         stream >> tgas_limit;
         stream >> code;
-        shared_ptr<xengine> engine = make_shared<xlua_engine>();
+        // the abi descriptor is optional, old clients don't send it
+        string abi;
+        if (stream.size() > 0) {
+            stream >> abi;
+        }
+        m_tgas_limit = tgas_limit;
+        m_abi = abi;
+        m_trace_ptr->m_cold_start = true;
+        shared_ptr<xengine> engine = xvm_engine_registry::instance().create(code);
         std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
         engine->publish_script(code, *this);
         m_trace_ptr->m_duration_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
         m_vm_service.m_vm_cache.put(m_contract_account, engine);
         m_contract_helper->set_contract_code(code);
         m_contract_helper->string_set(XPROPERTY_CONTRACT_TGAS_LIMIT_KEY, std::to_string(tgas_limit), true);
+        if (!abi.empty()) {
+            m_contract_helper->string_set(XPROPERTY_CONTRACT_ABI_KEY, abi, true);
+        }
     } catch(const xvm_error& e) {
         throw e;
     } catch(enum_xerror_code& e) {
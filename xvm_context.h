@@ -31,6 +31,8 @@ public:
     const std::string           m_exec_account;
     shared_ptr<xcontract_helper> m_contract_helper;
     xtransaction_trace_ptr      m_trace_ptr;
+    uint64_t                    m_tgas_limit{0};    // set when publishing code
+    std::string                 m_abi;              // set when publishing code
 
 private:
     std::string get_parent_address();
@@ -21,10 +21,14 @@ using	std::unordered_map;
 using	std::deque;
 using   std::make_shared;
 
-//const uint8_t ARG_TYPE_INT64    = 0;
+const uint8_t ARG_TYPE_INT64    = 0;
 const uint8_t ARG_TYPE_UINT64   = 1;
 const uint8_t ARG_TYPE_STRING   = 2;
 const uint8_t ARG_TYPE_BOOL     = 3;
+// the types below need the contract abi
+const uint8_t ARG_TYPE_BYTES    = 4;    // uint32 size + raw bytes
+const uint8_t ARG_TYPE_ARRAY    = 5;    // uint32 count + typed elements
+const uint8_t ARG_TYPE_MAP      = 6;    // uint32 count + typed key and typed value pairs
 
 
 #define xinfo_lua(fmt, ...)     xinfo("[lua] "  fmt , ##__VA_ARGS__)
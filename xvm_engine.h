@@ -18,5 +18,7 @@ class xengine
         virtual void publish_script(const std::string& code, xvm_context& ctx) = 0;
         // virtual int32_t add_abi(const string &code, const string& abi, xvm_context &ctx) = 0;
         virtual void process(common::xaccount_address_t const & contract_account, const std::string& code, xvm_context& ctx) = 0;
+        // bytes held by the engine, used by the engine cache
+        virtual std::size_t memory_usage() const { return 0; }
 };
 NS_END2
@@ -0,0 +1,105 @@
+// Copyright (c) 2017-2018 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+#include "xvm/xvm_engine_cache.h"
+#include "xvm/xvm_define.h"
+#include "xmetrics/xmetrics.h"
+
+#include <cassert>
+#include <iterator>
+
+NS_BEG2(top, xvm)
+
+xvm_engine_cache::xvm_engine_cache(std::size_t memory_budget, std::size_t shard_num)
+:m_shard_budget(memory_budget / (shard_num == 0 ? 1 : shard_num)) {
+    if (shard_num == 0) {
+        shard_num = 1;
+    }
+    for (std::size_t i = 0; i < shard_num; i++) {
+        m_shards.push_back(std::unique_ptr<xcache_shard_t>(new xcache_shard_t()));
+    }
+}
+
+xvm_engine_cache::xcache_shard_t & xvm_engine_cache::shard(common::xaccount_address_t const & contract_account) {
+    auto idx = std::hash<common::xaccount_address_t>{}(contract_account) % m_shards.size();
+    return *m_shards[idx];
+}
+
+bool xvm_engine_cache::take(common::xaccount_address_t const & contract_account, std::shared_ptr<xengine>& engine) {
+    auto & s = shard(contract_account);
+    {
+        std::lock_guard<std::mutex> lock(s.lock);
+        auto it = s.index.find(contract_account);
+        if (it != s.index.end()) {
+            engine = it->second->engine;
+            s.memory_usage -= it->second->memory_usage;
+            s.lru.erase(it->second);
+            s.index.erase(it);
+        }
+    }
+
+    if (engine != nullptr) {
+        m_hit_count++;
+        XMETRICS_COUNTER_INCREMENT("xvm_engine_cache_hit", 1);
+        return true;
+    }
+    m_miss_count++;
+    XMETRICS_COUNTER_INCREMENT("xvm_engine_cache_miss", 1);
+    return false;
+}
+
+void xvm_engine_cache::put(common::xaccount_address_t const & contract_account, std::shared_ptr<xengine> engine) {
+    assert(engine != nullptr);
+    // measure outside the lock, the engine is exclusively owned by the caller now
+    auto memory_usage = engine->memory_usage();
+    auto & s = shard(contract_account);
+    // evicted engines are released after unlock, closing a lua_State is not cheap
+    xcache_list_t evicted;
+    {
+        std::lock_guard<std::mutex> lock(s.lock);
+        auto it = s.index.find(contract_account);
+        if (it != s.index.end()) {
+            // another thread has put an engine of the same contract, keep the newer one
+            s.memory_usage -= it->second->memory_usage;
+            evicted.splice(evicted.end(), s.lru, it->second);
+            s.index.erase(it);
+        }
+        s.lru.push_front(xcache_entry_t{contract_account, std::move(engine), memory_usage});
+        s.index[contract_account] = s.lru.begin();
+        s.memory_usage += memory_usage;
+        evict(s, evicted);
+    }
+}
+
+void xvm_engine_cache::evict(xcache_shard_t & s, xcache_list_t & evicted) {
+    // always keep the most recently used engine, even if it alone exceeds the budget
+    while (s.memory_usage > m_shard_budget && s.lru.size() > 1) {
+        auto & entry = s.lru.back();
+        xdbg("[xvm_engine_cache::evict] contract %s, memory %zu", entry.contract_account.c_str(), entry.memory_usage);
+        s.memory_usage -= entry.memory_usage;
+        s.index.erase(entry.contract_account);
+        evicted.splice(evicted.end(), s.lru, std::prev(s.lru.end()));
+        m_evict_count++;
+        XMETRICS_COUNTER_INCREMENT("xvm_engine_cache_evict", 1);
+    }
+}
+
+void xvm_engine_cache::set_memory_budget(std::size_t memory_budget) {
+    m_shard_budget = memory_budget / m_shards.size();
+    for (auto & s : m_shards) {
+        xcache_list_t evicted;
+        std::lock_guard<std::mutex> lock(s->lock);
+        evict(*s, evicted);
+    }
+}
+
+std::size_t xvm_engine_cache::memory_usage() const {
+    std::size_t total{0};
+    for (auto & s : m_shards) {
+        std::lock_guard<std::mutex> lock(s->lock);
+        total += s->memory_usage;
+    }
+    return total;
+}
+
+NS_END2
@@ -0,0 +1,86 @@
+// Copyright (c) 2017-2018 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "xbasic/xns_macro.h"
+#include "xcommon/xaddress.h"
+#include "xvm_engine.h"
+NS_BEG2(top, xvm)
+#define XVM_ENGINE_CACHE_MEMORY_BUDGET  (64 * 1024 * 1024)
+#define XVM_ENGINE_CACHE_SHARD_NUM      16
+
+/**
+ * @brief sharded engine cache bounded by the memory the engines hold.
+ *        an engine is taken out of the cache while it is executing, so one
+ *        engine is never used by two threads at the same time
+ *
+ */
+class xvm_engine_cache {
+public:
+    explicit xvm_engine_cache(std::size_t memory_budget = XVM_ENGINE_CACHE_MEMORY_BUDGET, std::size_t shard_num = XVM_ENGINE_CACHE_SHARD_NUM);
+
+    /**
+     * @brief take the engine out of the cache for exclusive use
+     *
+     * @param contract_account  the contract account
+     * @param engine  the engine to store to
+     * @return true  hit
+     * @return false  miss
+     */
+    bool take(common::xaccount_address_t const & contract_account, std::shared_ptr<xengine>& engine);
+
+    /**
+     * @brief put the engine back to the cache, evict the least recently used
+     *        engines of the shard if the memory budget is exceeded
+     *
+     * @param contract_account  the contract account
+     * @param engine  the engine
+     */
+    void put(common::xaccount_address_t const & contract_account, std::shared_ptr<xengine> engine);
+
+    /**
+     * @brief Set the memory budget in bytes of the whole cache
+     *
+     * @param memory_budget  the memory budget
+     */
+    void set_memory_budget(std::size_t memory_budget);
+
+    uint64_t hit_count() const noexcept { return m_hit_count; }
+    uint64_t miss_count() const noexcept { return m_miss_count; }
+    uint64_t evict_count() const noexcept { return m_evict_count; }
+    std::size_t memory_usage() const;
+
+private:
+    struct xcache_entry_t {
+        common::xaccount_address_t  contract_account;
+        std::shared_ptr<xengine>    engine;
+        std::size_t                 memory_usage{0};
+    };
+    using xcache_list_t = std::list<xcache_entry_t>;
+
+    struct xcache_shard_t {
+        mutable std::mutex                                                          lock;
+        xcache_list_t                                                               lru;    // front is the most recently used
+        std::unordered_map<common::xaccount_address_t, xcache_list_t::iterator>     index;
+        std::size_t                                                                 memory_usage{0};
+    };
+
+    xcache_shard_t & shard(common::xaccount_address_t const & contract_account);
+    void evict(xcache_shard_t & s, xcache_list_t & evicted);
+
+private:
+    std::vector<std::unique_ptr<xcache_shard_t>>    m_shards;
+    std::atomic<std::size_t>                        m_shard_budget;
+    std::atomic<uint64_t>                           m_hit_count{0};
+    std::atomic<uint64_t>                           m_miss_count{0};
+    std::atomic<uint64_t>                           m_evict_count{0};
+};
+NS_END2
@@ -0,0 +1,44 @@
+// Copyright (c) 2017-2018 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+#include "xvm/xvm_engine_registry.h"
+#include "xvm/xlua_engine.h"
+#include "xvm/xreg_engine.h"
+
+#include <cassert>
+
+NS_BEG2(top, xvm)
+
+xvm_engine_registry& xvm_engine_registry::instance() {
+    static xvm_engine_registry * inst = new xvm_engine_registry();
+    return *inst;
+}
+
+xvm_engine_registry::xvm_engine_registry()
+:m_default([] { return std::make_shared<xlua_engine>(); }) {
+    register_engine(XREG_ENGINE_HEADER, [] { return std::make_shared<xreg_engine>(); });
+}
+
+void xvm_engine_registry::register_engine(const std::string& header, xengine_creator_t creator) {
+    assert(!header.empty());
+    std::lock_guard<std::mutex> lock(m_lock);
+    for (auto & entry : m_engines) {
+        if (entry.header == header) {
+            entry.creator = std::move(creator);
+            return;
+        }
+    }
+    m_engines.push_back(xengine_entry_t{header, std::move(creator)});
+}
+
+std::shared_ptr<xengine> xvm_engine_registry::create(const std::string& code) const {
+    std::lock_guard<std::mutex> lock(m_lock);
+    for (auto const & entry : m_engines) {
+        if (code.compare(0, entry.header.size(), entry.header) == 0) {
+            return entry.creator();
+        }
+    }
+    return m_default();
+}
+
+NS_END2
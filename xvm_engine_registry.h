@@ -0,0 +1,54 @@
+// Copyright (c) 2017-2018 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "xbasic/xns_macro.h"
+#include "xvm_engine.h"
+NS_BEG2(top, xvm)
+using xengine_creator_t = std::function<std::shared_ptr<xengine>()>;
+
+/**
+ * @brief engine backends keyed by the code header, code without a known header
+ *        goes to the default engine (lua)
+ *
+ */
+class xvm_engine_registry {
+public:
+    static xvm_engine_registry& instance();
+
+    /**
+     * @brief register the backend of the code starting with header
+     *
+     * @param header  the code header, not empty
+     * @param creator  creates an engine of the backend
+     */
+    void register_engine(const std::string& header, xengine_creator_t creator);
+
+    /**
+     * @brief create the engine to run the code
+     *
+     * @param code  the contract code
+     * @return std::shared_ptr<xengine>  the engine
+     */
+    std::shared_ptr<xengine> create(const std::string& code) const;
+
+private:
+    xvm_engine_registry();
+
+private:
+    struct xengine_entry_t {
+        std::string         header;
+        xengine_creator_t   creator;
+    };
+
+    mutable std::mutex              m_lock;
+    std::vector<xengine_entry_t>    m_engines;
+    xengine_creator_t               m_default;
+};
+NS_END2
@@ -0,0 +1,222 @@
+// Copyright (c) 2017-2018 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+#include "xvm/xvm_foreign_read_cache.h"
+#include "xmetrics/xmetrics.h"
+
+NS_BEG2(top, xvm)
+
+static std::size_t string_bytes(const std::string& key, const std::string& value) {
+    return XVM_FOREIGN_READ_CACHE_NODE_BYTES + key.size() + value.size();
+}
+
+static std::size_t map_bytes(const std::string& key, const std::map<std::string, std::string>& value) {
+    std::size_t bytes = XVM_FOREIGN_READ_CACHE_NODE_BYTES + key.size();
+    for (auto const & pair : value) {
+        bytes += XVM_FOREIGN_READ_CACHE_NODE_BYTES + pair.first.size() + pair.second.size();
+    }
+    return bytes;
+}
+
+xvm_foreign_read_cache& xvm_foreign_read_cache::instance() {
+    static xvm_foreign_read_cache * inst = new xvm_foreign_read_cache();
+    return *inst;
+}
+
+xvm_foreign_read_cache::xaccount_entry_t* xvm_foreign_read_cache::entry_at(const std::string& addr, xforeign_version_t const & version) {
+    if (version.block_hash.empty()) {
+        // the block is not known, the state can't be told apart, serve it from the store
+        return nullptr;
+    }
+    auto iter = m_accounts.find(addr);
+    if (iter == m_accounts.end()) {
+        if (m_accounts.size() >= XVM_FOREIGN_READ_CACHE_MAX_ACCOUNT) {
+            XMETRICS_COUNTER_INCREMENT("xvm_foreign_read_cache_evict", 1);
+            erase(m_accounts.find(m_lru.back()));
+        }
+        iter = m_accounts.emplace(addr, xaccount_entry_t{}).first;
+        iter->second.version = version;
+        m_lru.push_front(addr);
+        iter->second.lru_iter = m_lru.begin();
+    } else {
+        m_lru.splice(m_lru.begin(), m_lru, iter->second.lru_iter);
+    }
+    auto & entry = iter->second;
+    if (entry.version.height > version.height) {
+        // a reader behind the cached height, serve it from the store
+        return nullptr;
+    }
+    if (entry.version.height < version.height || entry.version.block_hash != version.block_hash) {
+        reset(entry, version);
+    }
+    return &entry;
+}
+
+bool xvm_foreign_read_cache::reserve(std::size_t bytes, const std::string& keeper) {
+    while (m_memory_usage + bytes > XVM_FOREIGN_READ_CACHE_MEMORY_BUDGET) {
+        if (m_lru.empty() || m_lru.back() == keeper) {
+            return false;
+        }
+        XMETRICS_COUNTER_INCREMENT("xvm_foreign_read_cache_evict", 1);
+        erase(m_accounts.find(m_lru.back()));
+    }
+    return true;
+}
+
+void xvm_foreign_read_cache::erase(std::unordered_map<std::string, xaccount_entry_t>::iterator iter) {
+    m_memory_usage -= iter->second.bytes;
+    m_lru.erase(iter->second.lru_iter);
+    m_accounts.erase(iter);
+}
+
+void xvm_foreign_read_cache::reset(xaccount_entry_t& entry, xforeign_version_t const & version) {
+    m_memory_usage -= entry.bytes;
+    entry.bytes = 0;
+    entry.version = version;
+    entry.maps.clear();
+    entry.strings.clear();
+    entry.fields.clear();
+}
+
+xforeign_map_ptr_t xvm_foreign_read_cache::get_map(const std::string& addr, const std::string& key, xforeign_version_t const & version) {
+    std::lock_guard<std::mutex> lock(m_lock);
+    auto entry = entry_at(addr, version);
+    if (entry != nullptr) {
+        auto iter = entry->maps.find(key);
+        if (iter != entry->maps.end()) {
+            XMETRICS_COUNTER_INCREMENT("xvm_foreign_read_cache_hit", 1);
+            return iter->second;
+        }
+    }
+    XMETRICS_COUNTER_INCREMENT("xvm_foreign_read_cache_miss", 1);
+    return nullptr;
+}
+
+void xvm_foreign_read_cache::put_map(const std::string& addr, const std::string& key, xforeign_version_t const & version, xforeign_map_ptr_t value) {
+    std::lock_guard<std::mutex> lock(m_lock);
+    auto entry = entry_at(addr, version);
+    if (entry == nullptr) {
+        return;
+    }
+    auto iter = entry->maps.find(key);
+    if (iter != entry->maps.end()) {
+        auto old_bytes = map_bytes(key, *iter->second);
+        entry->bytes -= old_bytes;
+        m_memory_usage -= old_bytes;
+        entry->maps.erase(iter);
+    }
+    auto bytes = map_bytes(key, *value);
+    if (!reserve(bytes, addr)) {
+        return;
+    }
+    entry->maps[key] = std::move(value);
+    entry->bytes += bytes;
+    m_memory_usage += bytes;
+}
+
+xforeign_string_ptr_t xvm_foreign_read_cache::get_string(const std::string& addr, const std::string& key, xforeign_version_t const & version) {
+    std::lock_guard<std::mutex> lock(m_lock);
+    auto entry = entry_at(addr, version);
+    if (entry != nullptr) {
+        auto iter = entry->strings.find(key);
+        if (iter != entry->strings.end()) {
+            XMETRICS_COUNTER_INCREMENT("xvm_foreign_read_cache_hit", 1);
+            return iter->second;
+        }
+    }
+    XMETRICS_COUNTER_INCREMENT("xvm_foreign_read_cache_miss", 1);
+    return nullptr;
+}
+
+void xvm_foreign_read_cache::put_string(const std::string& addr, const std::string& key, xforeign_version_t const & version, xforeign_string_ptr_t value) {
+    std::lock_guard<std::mutex> lock(m_lock);
+    auto entry = entry_at(addr, version);
+    if (entry == nullptr) {
+        return;
+    }
+    auto iter = entry->strings.find(key);
+    if (iter != entry->strings.end()) {
+        auto old_bytes = string_bytes(key, *iter->second);
+        entry->bytes -= old_bytes;
+        m_memory_usage -= old_bytes;
+        entry->strings.erase(iter);
+    }
+    auto bytes = string_bytes(key, *value);
+    if (!reserve(bytes, addr)) {
+        return;
+    }
+    entry->strings[key] = std::move(value);
+    entry->bytes += bytes;
+    m_memory_usage += bytes;
+}
+
+xforeign_string_ptr_t xvm_foreign_read_cache::get_field(const std::string& addr, const std::string& key, const std::string& field, xforeign_version_t const & version) {
+    std::lock_guard<std::mutex> lock(m_lock);
+    auto entry = entry_at(addr, version);
+    if (entry != nullptr) {
+        auto fields = entry->fields.find(key);
+        if (fields != entry->fields.end()) {
+            auto iter = fields->second.find(field);
+            if (iter != fields->second.end()) {
+                XMETRICS_COUNTER_INCREMENT("xvm_foreign_read_cache_hit", 1);
+                return iter->second;
+            }
+        }
+        auto map = entry->maps.find(key);
+        if (map != entry->maps.end()) {
+            auto iter = map->second->find(field);
+            if (iter != map->second->end()) {
+                XMETRICS_COUNTER_INCREMENT("xvm_foreign_read_cache_hit", 1);
+                return std::make_shared<std::string>(iter->second);
+            }
+        }
+    }
+    XMETRICS_COUNTER_INCREMENT("xvm_foreign_read_cache_miss", 1);
+    return nullptr;
+}
+
+void xvm_foreign_read_cache::put_field(const std::string& addr, const std::string& key, const std::string& field, xforeign_version_t const & version, xforeign_string_ptr_t value) {
+    std::lock_guard<std::mutex> lock(m_lock);
+    auto entry = entry_at(addr, version);
+    if (entry == nullptr) {
+        return;
+    }
+    auto & fields = entry->fields[key];
+    auto iter = fields.find(field);
+    if (iter != fields.end()) {
+        auto old_bytes = string_bytes(field, *iter->second);
+        entry->bytes -= old_bytes;
+        m_memory_usage -= old_bytes;
+        fields.erase(iter);
+    }
+    auto bytes = string_bytes(field, *value);
+    if (!reserve(bytes, addr)) {
+        return;
+    }
+    fields[field] = std::move(value);
+    entry->bytes += bytes;
+    m_memory_usage += bytes;
+}
+
+void xvm_foreign_read_cache::invalidate(const std::string& addr, uint64_t height) {
+    std::lock_guard<std::mutex> lock(m_lock);
+    auto iter = m_accounts.find(addr);
+    if (iter != m_accounts.end() && iter->second.version.height < height) {
+        XMETRICS_COUNTER_INCREMENT("xvm_foreign_read_cache_invalidate", 1);
+        erase(iter);
+    }
+}
+
+void xvm_foreign_read_cache::clear() {
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_accounts.clear();
+    m_lru.clear();
+    m_memory_usage = 0;
+}
+
+std::size_t xvm_foreign_read_cache::memory_usage() {
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_memory_usage;
+}
+
+NS_END2
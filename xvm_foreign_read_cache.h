@@ -0,0 +1,106 @@
+// Copyright (c) 2017-2018 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "xbasic/xns_macro.h"
+NS_BEG2(top, xvm)
+#define XVM_FOREIGN_READ_CACHE_MAX_ACCOUNT      256
+#define XVM_FOREIGN_READ_CACHE_MEMORY_BUDGET    (32 * 1024 * 1024)
+#define XVM_FOREIGN_READ_CACHE_NODE_BYTES       64      // rough overhead of a cached string or map node
+
+using xforeign_map_ptr_t = std::shared_ptr<const std::map<std::string, std::string>>;
+using xforeign_string_ptr_t = std::shared_ptr<const std::string>;
+
+/**
+ * @brief the state of an account the properties are read at, the height alone doesn't tell
+ *        two blocks at the same height apart
+ *
+ */
+struct xforeign_version_t {
+    uint64_t        height{0};
+    std::string     block_hash;
+};
+
+/**
+ * @brief process wide cache of the properties read from other contracts, bounded by the bytes
+ *        it holds. an account's entries are only valid at the block they are read at, and are
+ *        dropped once a newer block of the account is committed
+ *
+ */
+class xvm_foreign_read_cache {
+public:
+    static xvm_foreign_read_cache& instance();
+
+    /**
+     * @brief get a cached map property
+     *
+     * @param addr  the owner of the property
+     * @param key  the property
+     * @param version  the current block of the owner
+     * @return xforeign_map_ptr_t  nullptr if not cached at the block
+     */
+    xforeign_map_ptr_t get_map(const std::string& addr, const std::string& key, xforeign_version_t const & version);
+    void put_map(const std::string& addr, const std::string& key, xforeign_version_t const & version, xforeign_map_ptr_t value);
+
+    xforeign_string_ptr_t get_string(const std::string& addr, const std::string& key, xforeign_version_t const & version);
+    void put_string(const std::string& addr, const std::string& key, xforeign_version_t const & version, xforeign_string_ptr_t value);
+
+    /**
+     * @brief get a cached field of a map property, served from the whole map when it is cached
+     *
+     * @param addr  the owner of the property
+     * @param key  the property
+     * @param field  the field of the map
+     * @param version  the current block of the owner
+     * @return xforeign_string_ptr_t  nullptr if not cached at the block
+     */
+    xforeign_string_ptr_t get_field(const std::string& addr, const std::string& key, const std::string& field, xforeign_version_t const & version);
+    void put_field(const std::string& addr, const std::string& key, const std::string& field, xforeign_version_t const & version, xforeign_string_ptr_t value);
+
+    /**
+     * @brief drop the entries of the account read below the height
+     *
+     * @param addr  the account a block is committed for
+     * @param height  the height of the block
+     */
+    void invalidate(const std::string& addr, uint64_t height);
+
+    void clear();
+
+    std::size_t memory_usage();
+
+private:
+    xvm_foreign_read_cache() = default;
+
+    struct xaccount_entry_t {
+        xforeign_version_t                                      version;
+        std::unordered_map<std::string, xforeign_map_ptr_t>     maps;
+        std::unordered_map<std::string, xforeign_string_ptr_t>  strings;
+        // single fields read without copying the whole map, keyed by property then field
+        std::unordered_map<std::string, std::unordered_map<std::string, xforeign_string_ptr_t>> fields;
+        std::size_t                                             bytes{0};
+        std::list<std::string>::iterator                        lru_iter;
+    };
+
+    // the entry of the account at the block, reset if it is older or of another block at the height
+    xaccount_entry_t* entry_at(const std::string& addr, xforeign_version_t const & version);
+    // make room for bytes more, the least recently used accounts other than the keeper go first
+    bool reserve(std::size_t bytes, const std::string& keeper);
+    void erase(std::unordered_map<std::string, xaccount_entry_t>::iterator iter);
+    void reset(xaccount_entry_t& entry, xforeign_version_t const & version);
+
+private:
+    std::mutex                                                  m_lock;
+    std::unordered_map<std::string, xaccount_entry_t>           m_accounts;
+    std::list<std::string>                                      m_lru;      // front is the most recently used
+    std::size_t                                                 m_memory_usage{0};
+};
+NS_END2
@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #pragma once
+#include <algorithm>
 #include <string>
 #include <vector>
 #include "xvm_define.h"
@@ -30,6 +31,51 @@ struct xlua_chain_func
 };
 #define DB_OP_INSTRUCTION_COUNT     50
 #define FUNC_OP_INSTRUCTION_COUNT   5
+#define DB_OP_BATCH_ITEM_INSTRUCTION_COUNT  10
+
+// collect the string pairs of a lua table sorted by key, keys or values of other types are not allowed.
+// lua_next order depends on the hash seed of the state, the sort makes the writes the same on every node
+static void lua_table_to_pairs(lua_State *L, int idx, vector<std::pair<string, string>>& pairs, const char* func)
+{
+    lua_pushnil(L);
+    while (lua_next(L, idx) != 0) {
+        if (!lua_isstring(L, -2) || !lua_isstring(L, -1)) {
+            throw xvm_error{enum_xvm_error_code::enum_vm_exception, string(func) + " error, table key value is not string"};
+        }
+        size_t key_len{0}, value_len{0};
+        // copy the key, lua_tolstring on a number key would confuse lua_next
+        lua_pushvalue(L, -2);
+        const char* key = lua_tolstring(L, -1, &key_len);
+        const char* value = lua_tolstring(L, -2, &value_len);
+        pairs.emplace_back(string(key, key_len), string(value, value_len));
+        lua_pop(L, 2);
+    }
+    std::sort(pairs.begin(), pairs.end());
+    // a number key and a string key converting to the same string would be written in table order
+    auto duplicate = std::adjacent_find(pairs.begin(), pairs.end(), [](const std::pair<string, string>& lhs, const std::pair<string, string>& rhs) {
+        return lhs.first == rhs.first;
+    });
+    if (duplicate != pairs.end()) {
+        throw xvm_error{enum_xvm_error_code::enum_vm_exception, string(func) + " error, duplicate key " + duplicate->first};
+    }
+}
+
+// collect the string values of a lua array
+static void lua_array_to_strings(lua_State *L, int idx, vector<string>& values, const char* func)
+{
+    auto len = lua_rawlen(L, idx);
+    values.reserve(len);
+    for (size_t i = 1; i <= len; i++) {
+        lua_rawgeti(L, idx, i);
+        if (!lua_isstring(L, -1)) {
+            throw xvm_error{enum_xvm_error_code::enum_vm_exception, string(func) + " error, array item is not string"};
+        }
+        size_t value_len{0};
+        const char* value = lua_tolstring(L, -1, &value_len);
+        values.emplace_back(value, value_len);
+        lua_pop(L, 1);
+    }
+}
 
 
 static int L_require_owner(lua_State *L)
@@ -291,6 +337,82 @@ static int L_hdel(lua_State *L)
     return 0;
 }
 
+static int L_mget(lua_State *L)
+{
+    vector<string> keys;
+    if (lua_istable(L, 1)) {
+        lua_array_to_strings(L, 1, keys, "mget");
+    } else {
+        throw xvm_error{enum_xvm_error_code::enum_vm_exception, "mget error, keys is not table"};
+    }
+    lua_addinstructioncount(L, DB_OP_INSTRUCTION_COUNT + DB_OP_BATCH_ITEM_INSTRUCTION_COUNT * keys.size());
+    xcontract_helper* contract_helper = reinterpret_cast<xcontract_helper*>(lua_getuserdata(L));
+    lua_createtable(L, 0, keys.size());
+    for (const auto& key : keys) {
+        auto value = contract_helper->string_get(key);
+        lua_pushlstring(L, key.data(), key.size());
+        lua_pushlstring(L, value.data(), value.size());
+        lua_rawset(L, -3);
+    }
+    return 1;
+}
+
+static int L_mset(lua_State *L)
+{
+    vector<std::pair<string, string>> pairs;
+    if (lua_istable(L, 1)) {
+        lua_table_to_pairs(L, 1, pairs, "mset");
+    } else {
+        throw xvm_error{enum_xvm_error_code::enum_vm_exception, "mset error, key values is not table"};
+    }
+    lua_addinstructioncount(L, DB_OP_INSTRUCTION_COUNT + DB_OP_BATCH_ITEM_INSTRUCTION_COUNT * pairs.size());
+    xcontract_helper* contract_helper = reinterpret_cast<xcontract_helper*>(lua_getuserdata(L));
+    for (const auto& pair : pairs) {
+        contract_helper->string_set(pair.first, pair.second);
+    }
+    return 0;
+}
+
+static int L_hmget(lua_State *L)
+{
+    string key;
+    vector<string> fields;
+    if (lua_isstring(L, 1) && lua_istable(L, 2)) {
+        key = luaL_checkstring(L, 1);
+        lua_array_to_strings(L, 2, fields, "hmget");
+    } else {
+        throw xvm_error{enum_xvm_error_code::enum_vm_exception, "hmget error, key is not string or fields is not table"};
+    }
+    lua_addinstructioncount(L, DB_OP_INSTRUCTION_COUNT + DB_OP_BATCH_ITEM_INSTRUCTION_COUNT * fields.size());
+    xcontract_helper* contract_helper = reinterpret_cast<xcontract_helper*>(lua_getuserdata(L));
+    lua_createtable(L, 0, fields.size());
+    for (const auto& field : fields) {
+        auto value = contract_helper->map_get(key, field);
+        lua_pushlstring(L, field.data(), field.size());
+        lua_pushlstring(L, value.data(), value.size());
+        lua_rawset(L, -3);
+    }
+    return 1;
+}
+
+static int L_hmset(lua_State *L)
+{
+    string key;
+    vector<std::pair<string, string>> pairs;
+    if (lua_isstring(L, 1) && lua_istable(L, 2)) {
+        key = luaL_checkstring(L, 1);
+        lua_table_to_pairs(L, 2, pairs, "hmset");
+    } else {
+        throw xvm_error{enum_xvm_error_code::enum_vm_exception, "hmset error, key is not string or field values is not table"};
+    }
+    lua_addinstructioncount(L, DB_OP_INSTRUCTION_COUNT + DB_OP_BATCH_ITEM_INSTRUCTION_COUNT * pairs.size());
+    xcontract_helper* contract_helper = reinterpret_cast<xcontract_helper*>(lua_getuserdata(L));
+    for (const auto& pair : pairs) {
+        contract_helper->map_set(key, pair.first, pair.second);
+    }
+    return 0;
+}
+
 static int L_grant(lua_State *L)
 {
     lua_addinstructioncount(L, DB_OP_INSTRUCTION_COUNT);
@@ -361,6 +483,10 @@ static xlua_chain_func g_lua_chain_func[] = {
     { "hget",                   L_hget},
     { "hlen",                   L_hlen },
     { "hdel",                   L_hdel },
+    { "mget",                   L_mget },
+    { "mset",                   L_mset },
+    { "hmget",                  L_hmget },
+    { "hmset",                  L_hmset },
     { "grant",                  L_grant },
     { "random_seed",            L_random_seed },
 };
@@ -0,0 +1,91 @@
+// Copyright (c) 2017-2018 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+#include "xvm/xvm_profiler.h"
+
+#include <sstream>
+
+NS_BEG2(top, xvm)
+
+std::atomic<bool> xvm_profiler::s_enabled{false};
+
+void xhost_call_stat_t::add(uint64_t ns, uint64_t size) {
+    count++;
+    total_ns += ns;
+    bytes += size;
+    std::size_t idx{0};
+    while (ns != 0 && idx < XVM_PROFILE_BUCKET_NUM - 1) {
+        ns >>= 1;
+        idx++;
+    }
+    buckets[idx]++;
+}
+
+void xhost_call_stat_t::merge(xhost_call_stat_t const & other) {
+    count += other.count;
+    total_ns += other.total_ns;
+    bytes += other.bytes;
+    for (std::size_t i = 0; i < XVM_PROFILE_BUCKET_NUM; i++) {
+        buckets[i] += other.buckets[i];
+    }
+}
+
+xhost_call_scope_t::~xhost_call_scope_t() {
+    if (m_profile != nullptr) {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count();
+        (*m_profile)[m_name].add(static_cast<uint64_t>(ns), m_bytes);
+    }
+}
+
+xvm_profiler& xvm_profiler::instance() {
+    static xvm_profiler * inst = new xvm_profiler();
+    return *inst;
+}
+
+void xvm_profiler::aggregate(const std::string& contract_account, xhost_call_profile_t const & profile, uint64_t duration_us) {
+    std::lock_guard<std::mutex> lock(m_lock);
+    auto & contract = m_contracts[contract_account];
+    contract.tx_count++;
+    contract.duration_us += duration_us;
+    for (auto const & call : profile) {
+        contract.host_calls[call.first].merge(call.second);
+    }
+}
+
+std::string xvm_profiler::dump() const {
+    std::lock_guard<std::mutex> lock(m_lock);
+    std::ostringstream out;
+    out << "{";
+    bool first_contract{true};
+    for (auto const & contract : m_contracts) {
+        out << (first_contract ? "" : ",") << "\"" << contract.first << "\":{"
+            << "\"tx_count\":" << contract.second.tx_count
+            << ",\"duration_us\":" << contract.second.duration_us
+            << ",\"host_calls\":{";
+        first_contract = false;
+        bool first_call{true};
+        for (auto const & call : contract.second.host_calls) {
+            auto const & stat = call.second;
+            out << (first_call ? "" : ",") << "\"" << call.first << "\":{"
+                << "\"count\":" << stat.count
+                << ",\"total_ns\":" << stat.total_ns
+                << ",\"bytes\":" << stat.bytes
+                << ",\"log2_ns_histogram\":[";
+            first_call = false;
+            for (std::size_t i = 0; i < XVM_PROFILE_BUCKET_NUM; i++) {
+                out << (i == 0 ? "" : ",") << stat.buckets[i];
+            }
+            out << "]}";
+        }
+        out << "}}";
+    }
+    out << "}";
+    return out.str();
+}
+
+void xvm_profiler::clear() {
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_contracts.clear();
+}
+
+NS_END2
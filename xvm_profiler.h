@@ -0,0 +1,104 @@
+// Copyright (c) 2017-2018 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "xbasic/xns_macro.h"
+NS_BEG2(top, xvm)
+#define XVM_PROFILE_BUCKET_NUM  32      // bucket i counts the calls taking [2^(i-1), 2^i) ns
+
+/**
+ * @brief the stat of one kind of host call
+ *
+ */
+struct xhost_call_stat_t {
+    uint64_t    count{0};
+    uint64_t    total_ns{0};
+    uint64_t    bytes{0};
+    uint64_t    buckets[XVM_PROFILE_BUCKET_NUM]{};
+
+    void add(uint64_t ns, uint64_t size);
+    void merge(xhost_call_stat_t const & other);
+};
+
+// host call name -> stat, the profile of one transaction
+using xhost_call_profile_t = std::map<std::string, xhost_call_stat_t>;
+
+/**
+ * @brief time a host call and add it to the profile, does nothing if profile is NULL
+ *
+ */
+class xhost_call_scope_t {
+public:
+    xhost_call_scope_t(xhost_call_profile_t* profile, const char* name, uint64_t bytes = 0)
+    :m_profile(profile), m_name(name), m_bytes(bytes) {
+        if (m_profile != nullptr) {
+            m_start = std::chrono::steady_clock::now();
+        }
+    }
+    ~xhost_call_scope_t();
+    xhost_call_scope_t(const xhost_call_scope_t&) = delete;
+    xhost_call_scope_t& operator=(const xhost_call_scope_t&) = delete;
+
+    void add_bytes(uint64_t bytes) noexcept { m_bytes += bytes; }
+
+private:
+    xhost_call_profile_t*                   m_profile;
+    const char*                             m_name;
+    uint64_t                                m_bytes;
+    std::chrono::steady_clock::time_point   m_start;
+};
+
+/**
+ * @brief opt-in host call profiler. when enabled, each transaction trace carries its
+ *        host call profile, and the profiles are aggregated per contract for dumping
+ *
+ */
+class xvm_profiler {
+public:
+    static xvm_profiler& instance();
+
+    static bool enabled() noexcept { return s_enabled.load(std::memory_order_relaxed); }
+    void set_enabled(bool enabled) noexcept { s_enabled.store(enabled, std::memory_order_relaxed); }
+
+    /**
+     * @brief add the profile of a transaction to the contract
+     *
+     * @param contract_account  the contract account
+     * @param profile  the host call profile of the transaction
+     * @param duration_us  the duration of the transaction
+     */
+    void aggregate(const std::string& contract_account, xhost_call_profile_t const & profile, uint64_t duration_us);
+
+    /**
+     * @brief dump the aggregated stats as json
+     *
+     * @return std::string  {"contract":{"tx_count":n,"duration_us":n,"host_calls":{"name":{...}}}}
+     */
+    std::string dump() const;
+
+    void clear();
+
+private:
+    xvm_profiler() = default;
+
+private:
+    struct xcontract_profile_t {
+        uint64_t                tx_count{0};
+        uint64_t                duration_us{0};
+        xhost_call_profile_t    host_calls;
+    };
+
+    static std::atomic<bool>                                    s_enabled;
+    mutable std::mutex                                          m_lock;
+    std::unordered_map<std::string, xcontract_profile_t>        m_contracts;
+};
+NS_END2
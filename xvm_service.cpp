@@ -4,6 +4,7 @@
 #include "xvm_service.h"
 #include "xbasic/xscope_executer.h"
 #include "xbasic/xmodule_type.h"
+#include "xconfig/xconfig_register.h"
 #include "xerror/xvm_error.h"
 #include "xvm_context.h"
 
@@ -13,8 +14,11 @@ NS_BEG2(top, xvm)
 
 REG_XMODULE_LOG(chainbase::enum_xmodule_type::xmodule_type_xvm, xvm::xvm_error_to_string, (int32_t)xvm::enum_xvm_error_code::error_base + 1, (int32_t)xvm::enum_xvm_error_code::error_max);
 
-xvm_service::xvm_service()
-:m_vm_cache(16) {
+xvm_service::xvm_service(std::size_t engine_cache_budget)
+:m_vm_cache(engine_cache_budget) {
+    uint32_t stats_enabled{0};
+    config::xconfig_register_t::get_instance().get(std::string(XVM_SERVICE_STATS_CONFIG), stats_enabled);
+    m_stats.set_enabled(stats_enabled != 0);
 }
 
 xtransaction_trace_ptr xvm_service::deal_transaction(const xtransaction_ptr_t& trx, xaccount_context_t* account_context) {
@@ -22,12 +26,25 @@ xtransaction_trace_ptr xvm_service::deal_transaction(const xtransaction_ptr_t& t
     xinfo_lua("target action:%s",trx->get_target_action().get_action_str().c_str());
 
     xtransaction_trace_ptr trace = std::make_shared<xtransaction_trace>();
-    xtop_scope_executer on_exit([trace] {
+    if (xvm_profiler::enabled()) {
+        trace->m_host_calls = std::make_shared<xhost_call_profile_t>();
+    }
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    xtop_scope_executer on_exit([this, trace, &trx, start] {
+        if (m_stats.enabled()) {
+            m_stats.record(*trace, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+        }
+        if (trace->m_host_calls != nullptr) {
+            xvm_profiler::instance().aggregate(trx->get_target_addr(), *trace->m_host_calls, trace->m_duration_us);
+        }
         xinfo_lua("tgas micro seconds:%lld, %u, errno:%d, %s", trace->m_duration_us, trace->m_instruction_usage, static_cast<uint32_t>(trace->m_errno), trace->m_errmsg.c_str());
      });
     try {
         shared_ptr<xvm_context> trx_context = make_shared<xvm_context>(*this, trx, account_context, trace);
+        trx_context->m_contract_helper->set_profile(trace->m_host_calls.get());
         trx_context->exec();
+        // property writes are buffered in the helper during exec, commit them once it succeeds
+        trx_context->m_contract_helper->flush();
     } catch(const xvm_error& e) {
         xwarn_lua("%d,%s", e.code().value(), e.what());
         trace->m_errno = static_cast<top::xvm::enum_xvm_error_code>(e.code().value());
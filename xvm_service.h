@@ -5,26 +5,36 @@
 #pragma once
 #include <string>
 #include "xbasic/xns_macro.h"
-#include "xbasic/xlru_cache.h"
 #include "xvm_trace.h"
 #include "xlua_engine.h"
+#include "xvm_engine_cache.h"
+#include "xvm_service_stats.h"
 #include "xvm_native_func.h"
+#include "xcontract_helper.h"
 #include "xstore/xaccount_context.h"
 NS_BEG2(top, xvm)
+#define XVM_SERVICE_STATS_CONFIG    "xvm_service_stats"     // config switch of xvm_service_stats, 1 to enable
 using data::xtransaction_t;
 using store::xaccount_context_t;
 using store::xstore_face_t;
-using basic::xlru_cache;
 
 class xvm_service {
  public:
-    xvm_service();
+    explicit xvm_service(std::size_t engine_cache_budget = XVM_ENGINE_CACHE_MEMORY_BUDGET);
     //~xvm_service();
+    /**
+     * @brief execute the transaction
+     *
+     * @param trx  the transaction
+     * @param account_context  the context of the target account
+     * @return xtransaction_trace_ptr  the trace
+     */
     xtransaction_trace_ptr deal_transaction(const data::xtransaction_ptr_t& trx, xaccount_context_t* account_context);
     native_handler* get_native_handler(string action_name);
  public:
-    xlru_cache<common::xaccount_address_t, shared_ptr<xengine>> m_vm_cache;
+    xvm_engine_cache                        m_vm_cache;
     xvm_native_func                         m_native_func;
+    xvm_service_stats                       m_stats;
     //todo db
     //todo config
 };
@@ -0,0 +1,121 @@
+// Copyright (c) 2017-2018 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+#include "xvm/xvm_service_stats.h"
+
+#include <algorithm>
+#include <sstream>
+
+NS_BEG2(top, xvm)
+
+std::size_t xvm_latency_histogram::bucket_of(uint64_t value) noexcept {
+    if (value < 16) {
+        return static_cast<std::size_t>(value);
+    }
+    int msb = 63 - __builtin_clzll(value);
+    return static_cast<std::size_t>((msb - 3) * 8 + (value >> (msb - 3)));
+}
+
+uint64_t xvm_latency_histogram::lower_bound_of(std::size_t bucket) noexcept {
+    if (bucket < 16) {
+        return bucket;
+    }
+    auto msb = bucket / 8 + 2;
+    return static_cast<uint64_t>(bucket % 8 + 8) << (msb - 3);
+}
+
+void xvm_latency_histogram::record(uint64_t latency_us) noexcept {
+    m_buckets[bucket_of(latency_us)]++;
+    m_count++;
+    m_max = std::max(m_max, latency_us);
+}
+
+void xvm_latency_histogram::merge(xvm_latency_histogram const & other) noexcept {
+    for (std::size_t i = 0; i < XVM_LATENCY_BUCKET_NUM; i++) {
+        m_buckets[i] += other.m_buckets[i];
+    }
+    m_count += other.m_count;
+    m_max = std::max(m_max, other.m_max);
+}
+
+uint64_t xvm_latency_histogram::percentile(double percentile) const noexcept {
+    if (m_count == 0) {
+        return 0;
+    }
+    auto rank = static_cast<uint64_t>(m_count * percentile / 100);
+    rank = std::min(std::max<uint64_t>(rank, 1), m_count);
+    uint64_t seen{0};
+    for (std::size_t i = 0; i < XVM_LATENCY_BUCKET_NUM; i++) {
+        seen += m_buckets[i];
+        if (seen >= rank) {
+            return lower_bound_of(i);
+        }
+    }
+    return m_max;
+}
+
+xvm_service_stats::xvm_service_stats()
+:m_start(std::chrono::steady_clock::now()) {
+}
+
+void xvm_service_stats::record(xtransaction_trace const & trace, uint64_t latency_us) {
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_tx_count++;
+    if (trace.m_errno != enum_xvm_error_code::ok) {
+        m_error_count++;
+    }
+    m_alloc_count += trace.m_alloc_count;
+    m_instruction_count += trace.m_instruction_usage;
+    if (trace.m_cold_start) {
+        m_cold.record(latency_us);
+    } else {
+        m_warm.record(latency_us);
+    }
+}
+
+static void dump_histogram(std::ostringstream & out, const char* name, xvm_latency_histogram const & histogram) {
+    out << "\"" << name << "\":{"
+        << "\"count\":" << histogram.count()
+        << ",\"p50\":" << histogram.percentile(50)
+        << ",\"p99\":" << histogram.percentile(99)
+        << ",\"p999\":" << histogram.percentile(99.9)
+        << ",\"max\":" << histogram.max()
+        << "}";
+}
+
+std::string xvm_service_stats::dump() const {
+    std::lock_guard<std::mutex> lock(m_lock);
+    auto elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count();
+    xvm_latency_histogram all;
+    all.merge(m_warm);
+    all.merge(m_cold);
+
+    std::ostringstream out;
+    out << "{\"tx_count\":" << m_tx_count
+        << ",\"error_count\":" << m_error_count
+        << ",\"elapsed_us\":" << elapsed_us
+        << ",\"tx_per_sec\":" << (elapsed_us > 0 ? m_tx_count * 1000000 / static_cast<uint64_t>(elapsed_us) : 0)
+        << ",\"allocs_per_tx\":" << (m_tx_count > 0 ? m_alloc_count / m_tx_count : 0)
+        << ",\"instructions_per_tx\":" << (m_tx_count > 0 ? m_instruction_count / m_tx_count : 0)
+        << ",\"latency_us\":{";
+    dump_histogram(out, "all", all);
+    out << ",";
+    dump_histogram(out, "warm", m_warm);
+    out << ",";
+    dump_histogram(out, "cold", m_cold);
+    out << "}}";
+    return out.str();
+}
+
+void xvm_service_stats::reset() {
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_start = std::chrono::steady_clock::now();
+    m_tx_count = 0;
+    m_error_count = 0;
+    m_alloc_count = 0;
+    m_instruction_count = 0;
+    m_warm = xvm_latency_histogram{};
+    m_cold = xvm_latency_histogram{};
+}
+
+NS_END2
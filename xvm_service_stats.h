@@ -0,0 +1,85 @@
+// Copyright (c) 2017-2018 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include "xbasic/xns_macro.h"
+#include "xvm_trace.h"
+NS_BEG2(top, xvm)
+#define XVM_LATENCY_BUCKET_NUM  496     // 8 sub buckets per power of 2, error within 12.5%
+
+/**
+ * @brief latency histogram in microseconds
+ *
+ */
+class xvm_latency_histogram {
+public:
+    void record(uint64_t latency_us) noexcept;
+    void merge(xvm_latency_histogram const & other) noexcept;
+
+    /**
+     * @brief the latency at the percentile
+     *
+     * @param percentile  in (0, 100]
+     * @return uint64_t  the lower bound of the bucket holding the percentile, 0 if empty
+     */
+    uint64_t percentile(double percentile) const noexcept;
+    uint64_t count() const noexcept { return m_count; }
+    uint64_t max() const noexcept { return m_max; }
+
+private:
+    static std::size_t bucket_of(uint64_t value) noexcept;
+    static uint64_t lower_bound_of(std::size_t bucket) noexcept;
+
+private:
+    uint64_t    m_buckets[XVM_LATENCY_BUCKET_NUM]{};
+    uint64_t    m_count{0};
+    uint64_t    m_max{0};
+};
+
+/**
+ * @brief opt-in throughput and latency of deal_transaction, split by warm and cold engine.
+ *        off by default: recording takes a lock shared by every thread using the service
+ *
+ */
+class xvm_service_stats {
+public:
+    xvm_service_stats();
+
+    bool enabled() const noexcept { return m_enabled.load(std::memory_order_relaxed); }
+    void set_enabled(bool enabled) noexcept { m_enabled.store(enabled, std::memory_order_relaxed); }
+
+    /**
+     * @brief record a finished transaction
+     *
+     * @param trace  the trace of the transaction
+     * @param latency_us  the time deal_transaction takes
+     */
+    void record(xtransaction_trace const & trace, uint64_t latency_us);
+
+    /**
+     * @brief dump the stats since the last reset as json
+     *
+     * @return std::string  {"tx_count":n,"tx_per_sec":n,"latency_us":{"all":{"p50":n,...},"warm":{...},"cold":{...}},...}
+     */
+    std::string dump() const;
+
+    void reset();
+
+private:
+    std::atomic<bool>                       m_enabled{false};
+    mutable std::mutex                      m_lock;
+    std::chrono::steady_clock::time_point   m_start;
+    uint64_t                                m_tx_count{0};
+    uint64_t                                m_error_count{0};
+    uint64_t                                m_alloc_count{0};
+    uint64_t                                m_instruction_count{0};
+    xvm_latency_histogram                   m_warm;
+    xvm_latency_histogram                   m_cold;
+};
+NS_END2
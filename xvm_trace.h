@@ -8,6 +8,7 @@
 #include "xbasic/xns_macro.h"
 #include "xvm_define.h"
 #include "xerror/xvm_error_code.h"
+#include "xvm_profiler.h"
 
 NS_BEG2(top, xvm)
 // using std::chrono::time_point;
@@ -25,6 +26,10 @@ struct xtransaction_trace
     microseconds::rep               m_duration_us{0};
     uint32_t                        m_tgas_usage{0};
     uint32_t                        m_disk_usage{0};
+    uint64_t                        m_memory_peak{0};   // peak bytes of the lua state
+    std::shared_ptr<xhost_call_profile_t> m_host_calls;  // set only when the profiler is enabled
+    uint32_t                        m_alloc_count{0};   // allocations of the lua state
+    bool                            m_cold_start{false};    // the engine is created for the transaction
 };
 
 using xtransaction_trace_ptr = std::shared_ptr<xtransaction_trace>;